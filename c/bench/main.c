@@ -0,0 +1,537 @@
+// Component microbenchmarks for c/lib.
+//
+// Each benchmark drives one component with synthetic input at several
+// sizes. Every (benchmark, size) pair is run a few times untimed to warm
+// caches and the allocator, then timed over a number of repetitions; we
+// report the median and the median absolute deviation of ns/op, plus
+// throughput. Results also go out as CSV in the tool,N,duration format
+// time.sh writes, with the median duration of one repetition in seconds,
+// so the same R code can plot them.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "events.h"
+#include "id_index.h"
+#include "indexed_book.h"
+#include "order.h"
+#include "order_pool.h"
+#include "price_bitmap.h"
+#include "qsort_orders.h"
+#include "radix_sort.h"
+#include "radix_sort_byte.h"
+#include "timing.h"
+
+// ---------- Synthetic Input ----------
+
+static uint64_t rng_state = 0x9e3779b97f4a7c15u;
+
+static inline uint32_t rng_next(void) {
+  // xorshift64*
+  rng_state ^= rng_state >> 12;
+  rng_state ^= rng_state << 25;
+  rng_state ^= rng_state >> 27;
+  return (uint32_t)((rng_state * 2685821657736338717u) >> 32);
+}
+
+static int random_price(void) { return (int)(rng_next() % 20001) - 10000; }
+static int random_quantity(void) { return 1 + (int)(rng_next() % 1000000); }
+
+static void shuffle_ints(int *a, size_t n) {
+  for (size_t i = n; i > 1; i--) {
+    size_t j = rng_next() % i;
+    int tmp = a[i - 1];
+    a[i - 1] = a[j];
+    a[j] = tmp;
+  }
+}
+
+static void *xmalloc(size_t size) {
+  void *p = malloc(size);
+  if (!p) {
+    perror("malloc");
+    exit(EXIT_FAILURE);
+  }
+  return p;
+}
+
+// ---------- Indexed Book ----------
+
+// The engines' id lookup: both sides of an IndexedBook behind one IdIndex
+typedef struct {
+  OrderPool pool;
+  IndexedBook book;
+  Order **orders;
+  int *ids; // shuffled lookup keys
+} BookContext;
+
+static void *book_setup(size_t n, bool filled, int key_offset) {
+  BookContext *ctx = xmalloc(sizeof *ctx);
+  init_order_pool(&ctx->pool, 1024);
+  init_indexed_book(&ctx->book);
+  ctx->orders = xmalloc(n * sizeof *ctx->orders);
+  ctx->ids = xmalloc(n * sizeof *ctx->ids);
+  for (size_t i = 0; i < n; i++) {
+    ctx->orders[i] = allocate_order(&ctx->pool, (int)i, ORDER_BUY,
+                                    random_price(), random_quantity());
+    if (filled)
+      add_book_order(&ctx->book, ctx->orders[i]);
+    ctx->ids[i] = (int)i + key_offset;
+  }
+  shuffle_ints(ctx->ids, n);
+  return ctx;
+}
+
+static void *book_setup_empty(size_t n) { return book_setup(n, false, 0); }
+static void *book_setup_hits(size_t n) { return book_setup(n, true, 0); }
+static void *book_setup_misses(size_t n) {
+  return book_setup(n, true, (int)n);
+}
+
+static void book_teardown(void *p) {
+  BookContext *ctx = p;
+  free_indexed_book(&ctx->book);
+  free_order_pool(&ctx->pool);
+  free(ctx->orders);
+  free(ctx->ids);
+  free(ctx);
+}
+
+static size_t book_add(void *p, size_t n) {
+  BookContext *ctx = p;
+  for (size_t i = 0; i < n; i++)
+    add_book_order(&ctx->book, ctx->orders[i]);
+  return n;
+}
+
+static volatile uintptr_t sink; // keeps lookups from being optimised away
+
+static size_t book_find(void *p, size_t n) {
+  BookContext *ctx = p;
+  uintptr_t acc = 0;
+  for (size_t i = 0; i < n; i++)
+    acc ^= (uintptr_t)find_book_order(&ctx->book, ctx->ids[i]);
+  sink = acc;
+  return n;
+}
+
+static size_t book_remove(void *p, size_t n) {
+  BookContext *ctx = p;
+  uintptr_t acc = 0;
+  for (size_t i = 0; i < n; i++)
+    acc ^= (uintptr_t)remove_book_order(&ctx->book, ctx->ids[i]);
+  sink = acc;
+  return n;
+}
+
+static size_t book_sort_qsort(void *p, size_t n) {
+  BookContext *ctx = p;
+  sort_book_side(&ctx->book, &ctx->book.buys, sort_bids_qsort);
+  return n;
+}
+
+// ---------- Id Index ----------
+
+typedef struct {
+  IdIndex index;
+  Order dummy;
+} IndexContext;
+
+static void *index_setup(size_t n) {
+  IndexContext *ctx = xmalloc(sizeof *ctx);
+  id_index_init(&ctx->index, 0);
+  for (size_t i = 0; i < n; i++)
+    id_index_put(&ctx->index, (int)i, &ctx->dummy);
+  return ctx;
+}
+
+static void index_teardown(void *p) {
+  IndexContext *ctx = p;
+  id_index_free(&ctx->index);
+  free(ctx);
+}
+
+// A sliding window of n live ids: every operation retires the oldest id
+// and inserts a new one, followed by a lookup of a live id. Lookups must
+// not slow down however many removals the index has seen.
+static size_t index_churn(void *p, size_t n) {
+  IndexContext *ctx = p;
+  uintptr_t acc = 0;
+  for (size_t round = 0; round < 4; round++) {
+    for (size_t i = 0; i < n; i++) {
+      int next = (int)(round * n + i + n);
+      id_index_remove(&ctx->index, next - (int)n);
+      id_index_put(&ctx->index, next, &ctx->dummy);
+      acc ^= (uintptr_t)id_index_get(&ctx->index, next - (int)(n / 2));
+    }
+  }
+  sink = acc;
+  return 4 * n;
+}
+
+// ---------- Price Levels ----------
+
+// A sparse book: OCCUPIED_LEVELS random levels out of the 20001, as far
+// from the best price the levels of a real book thin out. Every query
+// starts from a random price.
+#define OCCUPIED_LEVELS 64
+
+typedef struct {
+  PriceBitmap bitmap;
+  int count[PRICE_LEVELS]; // orders per level, as a bucketing engine keeps
+  int *starts;
+} LevelContext;
+
+static void *level_setup(size_t n) {
+  LevelContext *ctx = xmalloc(sizeof *ctx);
+  init_price_bitmap(&ctx->bitmap);
+  memset(ctx->count, 0, sizeof ctx->count);
+  for (int i = 0; i < OCCUPIED_LEVELS; i++) {
+    int price = random_price();
+    ctx->count[price - PRICE_MIN]++;
+    price_bitmap_set(&ctx->bitmap, price);
+  }
+  ctx->starts = xmalloc(n * sizeof *ctx->starts);
+  for (size_t i = 0; i < n; i++)
+    ctx->starts[i] = random_price();
+  return ctx;
+}
+
+static void level_teardown(void *p) {
+  LevelContext *ctx = p;
+  free(ctx->starts);
+  free(ctx);
+}
+
+static size_t level_scan_next(void *p, size_t n) {
+  LevelContext *ctx = p;
+  uintptr_t acc = 0;
+  for (size_t i = 0; i < n; i++) {
+    int level = ctx->starts[i] - PRICE_MIN;
+    while (level < PRICE_LEVELS && ctx->count[level] == 0)
+      level++;
+    acc += (uintptr_t)level;
+  }
+  sink = acc;
+  return n;
+}
+
+static size_t bitmap_next(void *p, size_t n) {
+  LevelContext *ctx = p;
+  uintptr_t acc = 0;
+  for (size_t i = 0; i < n; i++)
+    acc += (uintptr_t)price_bitmap_next(&ctx->bitmap, ctx->starts[i]);
+  sink = acc;
+  return n;
+}
+
+static size_t bitmap_prev(void *p, size_t n) {
+  LevelContext *ctx = p;
+  uintptr_t acc = 0;
+  for (size_t i = 0; i < n; i++)
+    acc += (uintptr_t)price_bitmap_prev(&ctx->bitmap, ctx->starts[i]);
+  sink = acc;
+  return n;
+}
+
+// A level filling up and draining again: set, then clear once it is empty
+static size_t bitmap_set_clear(void *p, size_t n) {
+  LevelContext *ctx = p;
+  for (size_t i = 0; i < n; i++) {
+    int price = ctx->starts[i];
+    if (!ctx->count[price - PRICE_MIN]) {
+      price_bitmap_set(&ctx->bitmap, price);
+      price_bitmap_clear(&ctx->bitmap, price);
+    }
+  }
+  return n;
+}
+
+// ---------- Pool ----------
+
+typedef struct {
+  OrderPool pool;
+  Order **orders;
+} PoolContext;
+
+static void *pool_setup(size_t n, bool recycle) {
+  PoolContext *ctx = xmalloc(sizeof *ctx);
+  init_order_pool(&ctx->pool, 1024);
+  ctx->orders = xmalloc(n * sizeof *ctx->orders);
+  if (recycle) {
+    for (size_t i = 0; i < n; i++)
+      ctx->orders[i] = allocate_order(&ctx->pool, (int)i, ORDER_BUY, 0, 1);
+    for (size_t i = 0; i < n; i++)
+      release_order(&ctx->pool, ctx->orders[i]);
+  }
+  return ctx;
+}
+
+static void *pool_setup_fresh(size_t n) { return pool_setup(n, false); }
+static void *pool_setup_recycled(size_t n) { return pool_setup(n, true); }
+
+static void pool_teardown(void *p) {
+  PoolContext *ctx = p;
+  free_order_pool(&ctx->pool);
+  free(ctx->orders);
+  free(ctx);
+}
+
+static size_t pool_allocate(void *p, size_t n) {
+  PoolContext *ctx = p;
+  for (size_t i = 0; i < n; i++)
+    ctx->orders[i] = allocate_order(&ctx->pool, (int)i, ORDER_BUY, 0, 1);
+  return n;
+}
+
+// ---------- Radix Sorts ----------
+
+typedef struct {
+  Order *orders;
+  Order **ptrs;
+} SortContext;
+
+static void *sort_setup(size_t n) {
+  SortContext *ctx = xmalloc(sizeof *ctx);
+  ctx->orders = xmalloc(n * sizeof *ctx->orders);
+  ctx->ptrs = xmalloc(n * sizeof *ctx->ptrs);
+  for (size_t i = 0; i < n; i++) {
+    ctx->orders[i] =
+        make_order((int)i, ORDER_BUY, random_price(), random_quantity());
+    ctx->ptrs[i] = &ctx->orders[i];
+  }
+  return ctx;
+}
+
+static void sort_teardown(void *p) {
+  SortContext *ctx = p;
+  free(ctx->orders);
+  free(ctx->ptrs);
+  free(ctx);
+}
+
+static size_t radix16_sort(void *p, size_t n) {
+  SortContext *ctx = p;
+  sort_bids_range(&ctx->ptrs, ctx->ptrs + n);
+  return n;
+}
+
+static size_t radix8_sort(void *p, size_t n) {
+  SortContext *ctx = p;
+  sort_bids_range_bytes(&ctx->ptrs, ctx->ptrs + n);
+  return n;
+}
+
+// ---------- Event Parser ----------
+
+typedef struct {
+  char *text;
+  size_t len;
+} ParseContext;
+
+static void *parse_setup(size_t n) {
+  ParseContext *ctx = xmalloc(sizeof *ctx);
+  ctx->text = xmalloc(n * 32 + 1);
+  ctx->len = 0;
+  for (size_t i = 0; i < n; i++) {
+    char *out = ctx->text + ctx->len;
+    switch (rng_next() % 5) {
+    case 0:
+      ctx->len += sprintf(out, "CREATE %s %d %d\n",
+                          rng_next() % 2 ? "Sell" : "Buy", random_quantity(),
+                          random_price());
+      break;
+    case 1:
+      ctx->len += sprintf(out, "UPDATE %zu %d\n", i, random_price());
+      break;
+    case 2:
+      ctx->len += sprintf(out, "REMOVE %zu\n", i);
+      break;
+    case 3:
+      ctx->len += sprintf(out, "BIDS\n");
+      break;
+    default:
+      ctx->len += sprintf(out, "ASKS\n");
+      break;
+    }
+  }
+  return ctx;
+}
+
+static void parse_teardown(void *p) {
+  ParseContext *ctx = p;
+  free(ctx->text);
+  free(ctx);
+}
+
+static size_t parse_events(void *p, size_t n) {
+  ParseContext *ctx = p;
+  EventIterator it;
+  event_iterator_init(&it, fmemopen(ctx->text, ctx->len, "r"));
+  Event event;
+  size_t count = 0;
+  while (event_iterator_next(&it, &event))
+    count++;
+  event_iterator_close(&it);
+  return count == n ? n : 0;
+}
+
+// ---------- Driver ----------
+
+typedef struct {
+  const char *name;
+  void *(*setup)(size_t n);
+  size_t (*run)(void *ctx, size_t n); // returns the operations performed
+  void (*teardown)(void *ctx);
+} Benchmark;
+
+static const Benchmark benchmarks[] = {
+    {"book_add", book_setup_empty, book_add, book_teardown},
+    {"book_find_hit", book_setup_hits, book_find, book_teardown},
+    {"book_find_miss", book_setup_misses, book_find, book_teardown},
+    {"book_remove", book_setup_hits, book_remove, book_teardown},
+    {"book_sort_qsort", book_setup_hits, book_sort_qsort, book_teardown},
+    {"index_churn", index_setup, index_churn, index_teardown},
+    {"level_scan_next", level_setup, level_scan_next, level_teardown},
+    {"bitmap_next", level_setup, bitmap_next, level_teardown},
+    {"bitmap_prev", level_setup, bitmap_prev, level_teardown},
+    {"bitmap_set_clear", level_setup, bitmap_set_clear, level_teardown},
+    {"pool_allocate", pool_setup_fresh, pool_allocate, pool_teardown},
+    {"pool_reuse", pool_setup_recycled, pool_allocate, pool_teardown},
+    {"radix16_sort", sort_setup, radix16_sort, sort_teardown},
+    {"radix8_sort", sort_setup, radix8_sort, sort_teardown},
+    {"parse_events", parse_setup, parse_events, parse_teardown},
+};
+#define NUM_BENCHMARKS (sizeof benchmarks / sizeof benchmarks[0])
+
+static int cmp_double(const void *a, const void *b) {
+  double x = *(const double *)a, y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+static double median(double *values, size_t n) {
+  qsort(values, n, sizeof *values, cmp_double);
+  return n % 2 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2;
+}
+
+// One repetition; returns ns/op and sets *ops, or exits on failure
+static double run_once(const Benchmark *b, size_t n, size_t *ops) {
+  void *ctx = b->setup(n);
+  uint64_t start = now_ticks();
+  *ops = b->run(ctx, n);
+  uint64_t end = now_ticks();
+  b->teardown(ctx);
+  if (*ops == 0) {
+    fprintf(stderr, "%s failed at N=%zu\n", b->name, n);
+    exit(EXIT_FAILURE);
+  }
+  return ticks_to_ns(end - start) / (double)*ops;
+}
+
+static bool known(const char *name) {
+  for (size_t i = 0; i < NUM_BENCHMARKS; i++)
+    if (strcmp(benchmarks[i].name, name) == 0)
+      return true;
+  return false;
+}
+
+static bool selected(const char *name, int argc, char **names) {
+  if (argc == 0)
+    return true;
+  for (int i = 0; i < argc; i++)
+    if (strcmp(names[i], name) == 0)
+      return true;
+  return false;
+}
+
+static void usage(const char *prog) {
+  fprintf(stderr,
+          "Usage: %s [--sizes N,N,...] [--reps R] [--warmup W]\n"
+          "          [--csv FILE] [benchmark ...]\n"
+          "Benchmarks:",
+          prog);
+  for (size_t i = 0; i < NUM_BENCHMARKS; i++)
+    fprintf(stderr, " %s", benchmarks[i].name);
+  fprintf(stderr, "\n");
+  exit(EXIT_FAILURE);
+}
+
+#define MAX_SIZES 32
+
+int main(int argc, char *argv[]) {
+  size_t sizes[MAX_SIZES] = {1000, 10000, 100000, 1000000};
+  size_t num_sizes = 4;
+  int reps = 11;
+  int warmup = 2;
+  const char *csv_file = NULL;
+
+  int i = 1;
+  for (; i < argc && argv[i][0] == '-'; i++) {
+    if (strcmp(argv[i], "--sizes") == 0 && i + 1 < argc) {
+      num_sizes = 0;
+      for (char *tok = strtok(argv[++i], ","); tok && num_sizes < MAX_SIZES;
+           tok = strtok(NULL, ","))
+        sizes[num_sizes++] = strtoul(tok, NULL, 10);
+    } else if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc) {
+      reps = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) {
+      warmup = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc) {
+      csv_file = argv[++i];
+    } else {
+      fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+      usage(argv[0]);
+    }
+  }
+  if (reps < 1)
+    usage(argv[0]);
+  for (int j = i; j < argc; j++) {
+    if (!known(argv[j])) {
+      fprintf(stderr, "Unknown benchmark: %s\n", argv[j]);
+      usage(argv[0]);
+    }
+  }
+
+  FILE *csv = csv_file ? fopen(csv_file, "w") : stdout;
+  if (!csv) {
+    perror(csv_file);
+    exit(EXIT_FAILURE);
+  }
+  fprintf(csv, "tool,N,duration\n");
+
+  calibrate_ticks();
+  double *samples = xmalloc(reps * sizeof *samples);
+  fprintf(stderr, "%-16s %9s %12s %10s %12s\n", "benchmark", "N", "ns/op",
+          "MAD", "Mops/s");
+
+  for (size_t b = 0; b < NUM_BENCHMARKS; b++) {
+    const Benchmark *bench = &benchmarks[b];
+    if (!selected(bench->name, argc - i, argv + i))
+      continue;
+    for (size_t s = 0; s < num_sizes; s++) {
+      size_t n = sizes[s];
+      size_t ops;
+      for (int w = 0; w < warmup; w++)
+        run_once(bench, n, &ops);
+      for (int r = 0; r < reps; r++)
+        samples[r] = run_once(bench, n, &ops);
+      double med = median(samples, reps);
+      for (int r = 0; r < reps; r++)
+        samples[r] = samples[r] > med ? samples[r] - med : med - samples[r];
+      double mad = median(samples, reps);
+
+      fprintf(stderr, "%-16s %9zu %12.2f %10.2f %12.2f\n", bench->name, n,
+              med, mad, 1e3 / med);
+      fprintf(csv, "%s,%zu,%.9f\n", bench->name, n, med * (double)ops / 1e9);
+      fflush(csv);
+    }
+  }
+
+  free(samples);
+  if (csv != stdout)
+    fclose(csv);
+  return 0;
+}
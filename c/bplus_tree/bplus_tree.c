@@ -0,0 +1,366 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bplus_tree.h"
+
+#define MIN_LEAF (BPT_LEAF_CAPACITY / 2)
+#define MIN_INNER (BPT_INNER_CAPACITY / 2)
+#define NODES_PER_SLAB 256
+
+// ---------- Keys ----------
+
+static inline BptKey make_key(const BPlusTree *tree, const Order *order) {
+  if (tree->type == ORDER_BUY)
+    return (BptKey){-order->price, -order->quantity, order->order_id};
+  return (BptKey){order->price, order->quantity, order->order_id};
+}
+
+static inline bool key_less(const BptKey *a, const BptKey *b) {
+  if (a->price != b->price)
+    return a->price < b->price;
+  if (a->quantity != b->quantity)
+    return a->quantity < b->quantity;
+  return a->order_id < b->order_id;
+}
+
+// Index of the first key in [0, size) that is not less than key
+static size_t lower_bound(const BptKey *keys, size_t size, const BptKey *key) {
+  size_t lo = 0, hi = size;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (key_less(&keys[mid], key))
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+// The child of an inner node whose range holds key
+static inline size_t child_index(const BptInner *inner, const BptKey *key) {
+  size_t lo = 0, hi = inner->size - 1;
+  while (lo < hi) { // first separator greater than key
+    size_t mid = lo + (hi - lo) / 2;
+    if (key_less(key, &inner->keys[mid]))
+      hi = mid;
+    else
+      lo = mid + 1;
+  }
+  return lo;
+}
+
+// ---------- Node Allocation ----------
+
+static BptLeaf *new_leaf(BPlusTree *tree) {
+  BptLeaf *leaf = slab_alloc(&tree->leaves);
+  leaf->next = NULL;
+  leaf->size = 0;
+  return leaf;
+}
+
+static BptInner *new_inner(BPlusTree *tree) {
+  BptInner *inner = slab_alloc(&tree->inners);
+  inner->size = 0;
+  return inner;
+}
+
+// ---------- Initialization and Cleanup ----------
+
+void init_bplus_tree(BPlusTree *tree, OrderType type) {
+  init_slab_pool(&tree->leaves, sizeof(BptLeaf), NODES_PER_SLAB);
+  init_slab_pool(&tree->inners, sizeof(BptInner), NODES_PER_SLAB);
+  tree->first = new_leaf(tree);
+  tree->root = tree->first;
+  tree->height = 0;
+  tree->size = 0;
+  tree->type = type;
+}
+
+void free_bplus_tree(BPlusTree *tree) {
+  free_slab_pool(&tree->leaves);
+  free_slab_pool(&tree->inners);
+  tree->root = NULL;
+  tree->first = NULL;
+  tree->size = 0;
+}
+
+// ---------- Insertion ----------
+
+// A node split on the way up: right is the new sibling and key the
+// smallest key under it
+typedef struct {
+  void *right;
+  BptKey key;
+} Split;
+
+static bool insert_leaf(BPlusTree *tree, BptLeaf *leaf, const BptKey *key,
+                        Split *split) {
+  size_t pos = lower_bound(leaf->keys, leaf->size, key);
+  if (leaf->size < BPT_LEAF_CAPACITY) {
+    memmove(leaf->keys + pos + 1, leaf->keys + pos,
+            (leaf->size - pos) * sizeof *leaf->keys);
+    leaf->keys[pos] = *key;
+    leaf->size++;
+    return false;
+  }
+
+  BptLeaf *right = new_leaf(tree);
+  size_t mid = BPT_LEAF_CAPACITY / 2;
+  right->size = BPT_LEAF_CAPACITY - mid;
+  memcpy(right->keys, leaf->keys + mid, right->size * sizeof *leaf->keys);
+  leaf->size = mid;
+  right->next = leaf->next;
+  leaf->next = right;
+
+  BptLeaf *target = pos <= mid ? leaf : right;
+  if (target == right)
+    pos -= mid;
+  memmove(target->keys + pos + 1, target->keys + pos,
+          (target->size - pos) * sizeof *target->keys);
+  target->keys[pos] = *key;
+  target->size++;
+
+  split->right = right;
+  split->key = right->keys[0];
+  return true;
+}
+
+// Insert child right of children[idx], separated by key
+static bool insert_inner(BPlusTree *tree, BptInner *inner, size_t idx,
+                         const Split *child, Split *split) {
+  if (inner->size < BPT_INNER_CAPACITY) {
+    size_t tail = inner->size - idx - 1;
+    memmove(inner->keys + idx + 1, inner->keys + idx,
+            tail * sizeof *inner->keys);
+    memmove(inner->children + idx + 2, inner->children + idx + 1,
+            tail * sizeof *inner->children);
+    inner->keys[idx] = child->key;
+    inner->children[idx + 1] = child->right;
+    inner->size++;
+    return false;
+  }
+
+  // Lay out the overfull node, then share it between inner and right
+  BptKey keys[BPT_INNER_CAPACITY];
+  void *children[BPT_INNER_CAPACITY + 1];
+  memcpy(keys, inner->keys, idx * sizeof *keys);
+  keys[idx] = child->key;
+  memcpy(keys + idx + 1, inner->keys + idx,
+         (BPT_INNER_CAPACITY - 1 - idx) * sizeof *keys);
+  memcpy(children, inner->children, (idx + 1) * sizeof *children);
+  children[idx + 1] = child->right;
+  memcpy(children + idx + 2, inner->children + idx + 1,
+         (BPT_INNER_CAPACITY - 1 - idx) * sizeof *children);
+
+  BptInner *right = new_inner(tree);
+  size_t left_size = (BPT_INNER_CAPACITY + 1) / 2;
+  inner->size = left_size;
+  right->size = BPT_INNER_CAPACITY + 1 - left_size;
+  memcpy(inner->keys, keys, (left_size - 1) * sizeof *keys);
+  memcpy(inner->children, children, left_size * sizeof *children);
+  memcpy(right->keys, keys + left_size, (right->size - 1) * sizeof *keys);
+  memcpy(right->children, children + left_size,
+         right->size * sizeof *children);
+
+  split->right = right;
+  split->key = keys[left_size - 1];
+  return true;
+}
+
+static bool insert_node(BPlusTree *tree, void *node, size_t level,
+                        const BptKey *key, Split *split) {
+  if (level == 0)
+    return insert_leaf(tree, node, key, split);
+
+  BptInner *inner = node;
+  size_t idx = child_index(inner, key);
+  Split child;
+  if (!insert_node(tree, inner->children[idx], level - 1, key, &child))
+    return false;
+  return insert_inner(tree, inner, idx, &child, split);
+}
+
+void insert_bplus_order(BPlusTree *tree, const Order *order) {
+  BptKey key = make_key(tree, order);
+  Split split;
+  if (insert_node(tree, tree->root, tree->height, &key, &split)) {
+    BptInner *root = new_inner(tree);
+    root->size = 2;
+    root->keys[0] = split.key;
+    root->children[0] = tree->root;
+    root->children[1] = split.right;
+    tree->root = root;
+    tree->height++;
+  }
+  tree->size++;
+}
+
+// ---------- Removal ----------
+
+// Bring leaf children[idx] of parent back to MIN_LEAF keys
+static void rebalance_leaf(BPlusTree *tree, BptInner *parent, size_t idx) {
+  BptLeaf *leaf = parent->children[idx];
+  BptLeaf *left = idx > 0 ? parent->children[idx - 1] : NULL;
+  BptLeaf *right = idx + 1 < parent->size ? parent->children[idx + 1] : NULL;
+
+  if (left && left->size > MIN_LEAF) {
+    memmove(leaf->keys + 1, leaf->keys, leaf->size * sizeof *leaf->keys);
+    leaf->keys[0] = left->keys[--left->size];
+    leaf->size++;
+    parent->keys[idx - 1] = leaf->keys[0];
+    return;
+  }
+  if (right && right->size > MIN_LEAF) {
+    leaf->keys[leaf->size++] = right->keys[0];
+    right->size--;
+    memmove(right->keys, right->keys + 1, right->size * sizeof *right->keys);
+    parent->keys[idx] = right->keys[0];
+    return;
+  }
+
+  // Merge into the left one of the pair and drop the right one
+  if (left) {
+    right = leaf;
+    leaf = left;
+    idx--;
+  }
+  memcpy(leaf->keys + leaf->size, right->keys,
+         right->size * sizeof *right->keys);
+  leaf->size += right->size;
+  leaf->next = right->next;
+  slab_free(&tree->leaves, right);
+
+  size_t tail = parent->size - idx - 2;
+  memmove(parent->keys + idx, parent->keys + idx + 1,
+          tail * sizeof *parent->keys);
+  memmove(parent->children + idx + 1, parent->children + idx + 2,
+          tail * sizeof *parent->children);
+  parent->size--;
+}
+
+// Bring inner node children[idx] of parent back to MIN_INNER children
+static void rebalance_inner(BPlusTree *tree, BptInner *parent, size_t idx) {
+  BptInner *node = parent->children[idx];
+  BptInner *left = idx > 0 ? parent->children[idx - 1] : NULL;
+  BptInner *right = idx + 1 < parent->size ? parent->children[idx + 1] : NULL;
+
+  if (left && left->size > MIN_INNER) {
+    // Rotate left's last child through the parent's separator
+    memmove(node->keys + 1, node->keys, (node->size - 1) * sizeof *node->keys);
+    memmove(node->children + 1, node->children,
+            node->size * sizeof *node->children);
+    node->keys[0] = parent->keys[idx - 1];
+    node->children[0] = left->children[left->size - 1];
+    node->size++;
+    parent->keys[idx - 1] = left->keys[left->size - 2];
+    left->size--;
+    return;
+  }
+  if (right && right->size > MIN_INNER) {
+    node->keys[node->size - 1] = parent->keys[idx];
+    node->children[node->size] = right->children[0];
+    node->size++;
+    parent->keys[idx] = right->keys[0];
+    memmove(right->keys, right->keys + 1,
+            (right->size - 2) * sizeof *right->keys);
+    memmove(right->children, right->children + 1,
+            (right->size - 1) * sizeof *right->children);
+    right->size--;
+    return;
+  }
+
+  if (left) {
+    right = node;
+    node = left;
+    idx--;
+  }
+  node->keys[node->size - 1] = parent->keys[idx];
+  memcpy(node->keys + node->size, right->keys,
+         (right->size - 1) * sizeof *right->keys);
+  memcpy(node->children + node->size, right->children,
+         right->size * sizeof *right->children);
+  node->size += right->size;
+  slab_free(&tree->inners, right);
+
+  size_t tail = parent->size - idx - 2;
+  memmove(parent->keys + idx, parent->keys + idx + 1,
+          tail * sizeof *parent->keys);
+  memmove(parent->children + idx + 1, parent->children + idx + 2,
+          tail * sizeof *parent->children);
+  parent->size--;
+}
+
+// Returns whether key was found and removed
+static bool remove_node(BPlusTree *tree, void *node, size_t level,
+                        const BptKey *key) {
+  if (level == 0) {
+    BptLeaf *leaf = node;
+    size_t pos = lower_bound(leaf->keys, leaf->size, key);
+    if (pos == leaf->size || key_less(key, &leaf->keys[pos]))
+      return false;
+    leaf->size--;
+    memmove(leaf->keys + pos, leaf->keys + pos + 1,
+            (leaf->size - pos) * sizeof *leaf->keys);
+    return true;
+  }
+
+  BptInner *inner = node;
+  size_t idx = child_index(inner, key);
+  void *child = inner->children[idx];
+  if (!remove_node(tree, child, level - 1, key))
+    return false;
+
+  if (level == 1) {
+    if (((BptLeaf *)child)->size < MIN_LEAF)
+      rebalance_leaf(tree, inner, idx);
+  } else if (((BptInner *)child)->size < MIN_INNER) {
+    rebalance_inner(tree, inner, idx);
+  }
+  return true;
+}
+
+void remove_bplus_order(BPlusTree *tree, const Order *order) {
+  BptKey key = make_key(tree, order);
+  if (!remove_node(tree, tree->root, tree->height, &key))
+    return;
+  tree->size--;
+
+  // The root is exempt from the minimum, but an inner root with a single
+  // child is a wasted level
+  if (tree->height > 0 && ((BptInner *)tree->root)->size == 1) {
+    BptInner *root = tree->root;
+    tree->root = root->children[0];
+    tree->height--;
+    slab_free(&tree->inners, root);
+  }
+}
+
+// ---------- Visiting ----------
+
+void visit_bplus_orders(const BPlusTree *tree, ObVisitor visit, void *ctx) {
+  int sign = tree->type == ORDER_BUY ? -1 : 1;
+  for (const BptLeaf *leaf = tree->first; leaf; leaf = leaf->next) {
+    for (size_t i = 0; i < leaf->size; i++) {
+      const BptKey *k = &leaf->keys[i];
+      Order order = make_order(k->order_id, tree->type, sign * k->price,
+                               sign * k->quantity);
+      visit(&order, ctx);
+    }
+  }
+}
+
+// ---------- Statistics ----------
+
+void print_bplus_stats(const BPlusTree *tree, const char *label, FILE *out) {
+  double fill = tree->leaves.live
+                    ? (double)tree->size /
+                          (double)(tree->leaves.live * BPT_LEAF_CAPACITY)
+                    : 0.0;
+  fprintf(out,
+          "%-13s  %zu orders, height %zu, %zu leaves (fill %.3f), "
+          "%zu inner nodes\n",
+          label, tree->size, tree->height + 1, tree->leaves.live, fill,
+          tree->inners.live);
+}
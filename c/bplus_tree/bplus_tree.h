@@ -0,0 +1,64 @@
+// One side of the book as a B+tree keyed on (price, quantity, order_id).
+//
+// Orders live only in the leaves, which are linked left to right, so a
+// query is a sequential scan from the first leaf and nothing is ever
+// sorted. Inner nodes hold separator keys only; keys[i] is a lower bound
+// for every key under children[i + 1]. Nodes are tens of cache lines wide
+// and are allocated from slab pools, so the tree stays shallow (three
+// levels hold over 100k orders) and its nodes are cache-line aligned.
+//
+// Every operation is O(log n): inserts split full nodes on the way back
+// up, and removals borrow from or merge with a sibling when a node drops
+// below half full. As in chunked_sorted, the buy side stores price and
+// quantity negated, so both sides are ascending in printing order.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "order.h"
+#include "orderbook.h"
+#include "slab_pool.h"
+
+#define BPT_LEAF_CAPACITY 64  // keys per leaf
+#define BPT_INNER_CAPACITY 64 // children per inner node
+
+typedef struct {
+  int price;    // negated on the buy side
+  int quantity; // negated on the buy side
+  int order_id;
+} BptKey;
+
+typedef struct BptLeaf {
+  struct BptLeaf *next;
+  size_t size;
+  BptKey keys[BPT_LEAF_CAPACITY];
+} BptLeaf;
+
+typedef struct {
+  size_t size; // children in use
+  BptKey keys[BPT_INNER_CAPACITY - 1];
+  void *children[BPT_INNER_CAPACITY];
+} BptInner;
+
+typedef struct {
+  void *root;
+  size_t height; // inner levels above the leaves; 0 if the root is a leaf
+  BptLeaf *first;
+  size_t size; // orders in the tree
+  OrderType type;
+
+  SlabPool leaves;
+  SlabPool inners;
+} BPlusTree;
+
+void init_bplus_tree(BPlusTree *tree, OrderType type);
+void free_bplus_tree(BPlusTree *tree);
+void insert_bplus_order(BPlusTree *tree, const Order *order);
+// The order must be in this tree with the price and quantity it was
+// inserted with.
+void remove_bplus_order(BPlusTree *tree, const Order *order);
+// Visit the orders, best first, as Orders built on the fly
+void visit_bplus_orders(const BPlusTree *tree, ObVisitor visit, void *ctx);
+void print_bplus_stats(const BPlusTree *tree, const char *label, FILE *out);
@@ -0,0 +1,63 @@
+#include <stdio.h>
+
+#include "bplus_tree.h"
+#include "driver.h"
+#include "order.h"
+#include "orderbook.h"
+#include "sorted_sides.h"
+
+// The C counterpart of rust/btree: both sides are kept sorted at all
+// times in B+trees behind a single id index (see sorted_sides.h).
+
+// ---------- Side Operations ----------
+
+static void init_side(void *side, OrderType type) {
+  init_bplus_tree(side, type);
+}
+static void free_side(void *side) { free_bplus_tree(side); }
+static void insert_side(void *side, const Order *order) {
+  insert_bplus_order(side, order);
+}
+static void remove_side(void *side, const Order *order) {
+  remove_bplus_order(side, order);
+}
+static void visit_side(const void *side, ObVisitor visit, void *ctx) {
+  visit_bplus_orders(side, visit, ctx);
+}
+static void print_side_stats(const void *side, const char *label,
+                             FILE *out) {
+  print_bplus_stats(side, label, out);
+}
+
+static const SortedSideOps bplus_sides = {
+    .side_size = sizeof(BPlusTree),
+    .init = init_side,
+    .free = free_side,
+    .insert = insert_side,
+    .remove = remove_side,
+    .visit = visit_side,
+    .print_stats = print_side_stats,
+    .labels = {[ORDER_BUY] = "buy tree:", [ORDER_SELL] = "sell tree:"},
+};
+
+// ---------- Backend ----------
+
+static void *init_book(void) { return init_sorted_sides(&bplus_sides); }
+
+static const ObBackend bplus_backend = {
+    .name = "bplus_tree",
+    .init_book = init_book,
+    .free_book = free_sorted_sides,
+    .create = sorted_sides_create,
+    .update = sorted_sides_update,
+    .remove = sorted_sides_remove,
+    .query = sorted_sides_query,
+    .print_stats = print_sorted_sides_stats,
+    .prefetch = sorted_sides_prefetch,
+};
+
+// ---------- Main ----------
+
+int main(int argc, char *argv[]) {
+  return run_driver(argc, argv, &bplus_backend);
+}
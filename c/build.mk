@@ -0,0 +1,46 @@
+# Build modes shared by the C Makefiles, selected with BUILD=<mode>:
+#
+#   release       -O2 (default)
+#   profile       AddressSanitizer, debug info and no optimisation
+#   pgo-generate  instrumented build that records a training profile
+#   pgo           LTO build optimised with the recorded profile
+#
+# Both PGO modes name objects, libraries and binaries with a .pgo suffix,
+# so PGO binaries sit next to the release ones and can be timed against
+# them. `make BUILD=pgo` at the top level runs the whole cycle.
+
+BUILD ?= release
+
+CC = cc
+AR = ar
+
+BUILD_MK_DIR := $(dir $(abspath $(lastword $(MAKEFILE_LIST))))
+PGO_DIR ?= $(abspath $(BUILD_MK_DIR)../_pgo)
+CC_IS_CLANG := $(shell $(CC) --version 2>/dev/null | grep -q clang && echo yes)
+
+ifeq ($(BUILD), profile)
+OPTFLAGS = -fsanitize=address -g -O0 -fno-omit-frame-pointer -DPROFILING
+else ifeq ($(BUILD), pgo-generate)
+OPTFLAGS = -O2 -fprofile-generate=$(PGO_DIR)
+SUFFIX = .pgo
+else ifeq ($(BUILD), pgo)
+ifeq ($(CC_IS_CLANG), yes)
+# clang needs the raw profiles merged first (the top-level Makefile does it)
+OPTFLAGS = -O2 -flto -fprofile-use=$(PGO_DIR)/default.profdata
+else
+# gcc keys profiles on object paths; benchmarks never run in training
+OPTFLAGS = -O2 -flto=auto -fprofile-use=$(PGO_DIR) -Wno-missing-profile
+AR = gcc-ar
+endif
+SUFFIX = .pgo
+else
+OPTFLAGS = -O2
+endif
+
+CFLAGS = -Wall -Wextra $(OPTFLAGS) -I. -I../lib
+
+LDLIBS = -pthread
+# shm_open lives in librt before glibc 2.34
+ifeq ($(shell uname -s), Linux)
+LDLIBS += -lrt
+endif
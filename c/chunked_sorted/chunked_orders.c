@@ -0,0 +1,247 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "chunked_orders.h"
+
+#define INITIAL_CHUNKS 4
+// Neighbouring chunks are merged when together they fill at most this
+// many entries, which leaves room for insertions before the next split.
+#define MERGE_THRESHOLD (CHUNK_CAPACITY / 2)
+
+// ---------- Entries ----------
+
+static inline ChunkEntry make_entry(const ChunkedOrders *side,
+                                    const Order *order) {
+  if (side->type == ORDER_BUY)
+    return (ChunkEntry){-order->price, -order->quantity, order->order_id};
+  return (ChunkEntry){order->price, order->quantity, order->order_id};
+}
+
+static inline bool entry_less(const ChunkEntry *a, const ChunkEntry *b) {
+  if (a->price != b->price)
+    return a->price < b->price;
+  if (a->quantity != b->quantity)
+    return a->quantity < b->quantity;
+  return a->order_id < b->order_id;
+}
+
+// Index of the first entry in [0, size) that is not less than key
+static size_t lower_bound(const ChunkEntry *entries, size_t size,
+                          const ChunkEntry *key) {
+  size_t lo = 0, hi = size;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (entry_less(&entries[mid], key))
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+// ---------- Chunk Management ----------
+
+static Chunk *acquire_chunk(ChunkedOrders *side) {
+  Chunk *chunk = side->free_chunks;
+  if (chunk) {
+    side->free_chunks = chunk->next_free;
+  } else {
+    chunk = malloc(sizeof *chunk);
+    if (!chunk) {
+      perror("malloc chunk");
+      exit(1);
+    }
+    side->allocated++;
+  }
+  chunk->size = 0;
+  return chunk;
+}
+
+static void release_chunk(ChunkedOrders *side, Chunk *chunk) {
+  chunk->next_free = side->free_chunks;
+  side->free_chunks = chunk;
+}
+
+// Open a gap for a new chunk at position idx
+static void insert_chunk_at(ChunkedOrders *side, size_t idx, Chunk *chunk) {
+  if (side->count == side->capacity) {
+    side->capacity *= 2;
+    side->chunks = realloc(side->chunks, side->capacity * sizeof *side->chunks);
+    side->last = realloc(side->last, side->capacity * sizeof *side->last);
+    if (!side->chunks || !side->last) {
+      perror("realloc chunks");
+      exit(1);
+    }
+  }
+  size_t tail = side->count - idx;
+  memmove(side->chunks + idx + 1, side->chunks + idx,
+          tail * sizeof *side->chunks);
+  memmove(side->last + idx + 1, side->last + idx, tail * sizeof *side->last);
+  side->chunks[idx] = chunk;
+  side->count++;
+  if (chunk->size > 0)
+    side->last[idx] = chunk->entries[chunk->size - 1];
+}
+
+static void remove_chunk_at(ChunkedOrders *side, size_t idx) {
+  release_chunk(side, side->chunks[idx]);
+  size_t tail = side->count - idx - 1;
+  memmove(side->chunks + idx, side->chunks + idx + 1,
+          tail * sizeof *side->chunks);
+  memmove(side->last + idx, side->last + idx + 1, tail * sizeof *side->last);
+  side->count--;
+}
+
+// Move the upper half of chunk idx into a new chunk after it
+static void split_chunk(ChunkedOrders *side, size_t idx) {
+  Chunk *chunk = side->chunks[idx];
+  Chunk *sibling = acquire_chunk(side);
+  size_t mid = chunk->size / 2;
+  sibling->size = chunk->size - mid;
+  memcpy(sibling->entries, chunk->entries + mid,
+         sibling->size * sizeof *chunk->entries);
+  chunk->size = mid;
+  side->last[idx] = chunk->entries[mid - 1];
+  insert_chunk_at(side, idx + 1, sibling);
+}
+
+// Append chunk idx + 1 to chunk idx and drop it
+static void merge_chunks(ChunkedOrders *side, size_t idx) {
+  Chunk *chunk = side->chunks[idx];
+  Chunk *next = side->chunks[idx + 1];
+  memcpy(chunk->entries + chunk->size, next->entries,
+         next->size * sizeof *next->entries);
+  chunk->size += next->size;
+  side->last[idx] = side->last[idx + 1];
+  remove_chunk_at(side, idx + 1);
+}
+
+// Index of the first chunk whose last entry is not less than key; equal
+// to count when key is beyond every chunk
+static size_t find_chunk(const ChunkedOrders *side, const ChunkEntry *key) {
+  return lower_bound(side->last, side->count, key);
+}
+
+// ---------- Initialization and Cleanup ----------
+
+void init_chunked_orders(ChunkedOrders *side, OrderType type) {
+  side->count = 0;
+  side->capacity = INITIAL_CHUNKS;
+  side->size = 0;
+  side->chunks = malloc(side->capacity * sizeof *side->chunks);
+  side->last = malloc(side->capacity * sizeof *side->last);
+  if (!side->chunks || !side->last) {
+    perror("malloc chunks");
+    exit(1);
+  }
+  side->type = type;
+  side->free_chunks = NULL;
+  side->allocated = 0;
+}
+
+void free_chunked_orders(ChunkedOrders *side) {
+  for (size_t i = 0; i < side->count; i++)
+    free(side->chunks[i]);
+  while (side->free_chunks) {
+    Chunk *next = side->free_chunks->next_free;
+    free(side->free_chunks);
+    side->free_chunks = next;
+  }
+  free(side->chunks);
+  free(side->last);
+  side->chunks = NULL;
+  side->last = NULL;
+  side->count = side->capacity = side->size = 0;
+}
+
+// ---------- Core Operations ----------
+
+void insert_chunked_order(ChunkedOrders *side, const Order *order) {
+  ChunkEntry entry = make_entry(side, order);
+  side->size++;
+
+  if (side->count == 0) {
+    Chunk *chunk = acquire_chunk(side);
+    chunk->entries[chunk->size++] = entry;
+    insert_chunk_at(side, 0, chunk);
+    return;
+  }
+
+  size_t idx = find_chunk(side, &entry);
+  if (idx == side->count)
+    idx--; // beyond every chunk, so it goes at the end of the last one
+
+  if (side->chunks[idx]->size == CHUNK_CAPACITY) {
+    split_chunk(side, idx);
+    if (entry_less(&side->last[idx], &entry))
+      idx++;
+  }
+
+  Chunk *chunk = side->chunks[idx];
+  size_t pos = lower_bound(chunk->entries, chunk->size, &entry);
+  memmove(chunk->entries + pos + 1, chunk->entries + pos,
+          (chunk->size - pos) * sizeof *chunk->entries);
+  chunk->entries[pos] = entry;
+  if (pos == chunk->size)
+    side->last[idx] = entry;
+  chunk->size++;
+}
+
+void remove_chunked_order(ChunkedOrders *side, const Order *order) {
+  ChunkEntry entry = make_entry(side, order);
+  size_t idx = find_chunk(side, &entry);
+  if (idx == side->count)
+    return;
+
+  Chunk *chunk = side->chunks[idx];
+  size_t pos = lower_bound(chunk->entries, chunk->size, &entry);
+  if (pos == chunk->size || entry_less(&entry, &chunk->entries[pos]))
+    return;
+
+  chunk->size--;
+  memmove(chunk->entries + pos, chunk->entries + pos + 1,
+          (chunk->size - pos) * sizeof *chunk->entries);
+  side->size--;
+
+  if (chunk->size == 0) {
+    remove_chunk_at(side, idx);
+    return;
+  }
+  if (pos == chunk->size)
+    side->last[idx] = chunk->entries[pos - 1];
+
+  if (idx + 1 < side->count &&
+      chunk->size + side->chunks[idx + 1]->size <= MERGE_THRESHOLD)
+    merge_chunks(side, idx);
+  else if (idx > 0 &&
+           side->chunks[idx - 1]->size + chunk->size <= MERGE_THRESHOLD)
+    merge_chunks(side, idx - 1);
+}
+
+// ---------- Visiting ----------
+
+void visit_chunked_orders(const ChunkedOrders *side, ObVisitor visit,
+                          void *ctx) {
+  int sign = side->type == ORDER_BUY ? -1 : 1;
+  for (size_t i = 0; i < side->count; i++) {
+    const Chunk *chunk = side->chunks[i];
+    for (size_t j = 0; j < chunk->size; j++) {
+      const ChunkEntry *e = &chunk->entries[j];
+      Order order = make_order(e->order_id, side->type, sign * e->price,
+                               sign * e->quantity);
+      visit(&order, ctx);
+    }
+  }
+}
+
+// ---------- Statistics ----------
+
+void print_chunked_stats(const ChunkedOrders *side, const char *label,
+                         FILE *out) {
+  double fill = side->count ? (double)side->size /
+                                  (double)(side->count * CHUNK_CAPACITY)
+                            : 0.0;
+  fprintf(out, "%-13s  %zu orders, %zu chunks, fill %.3f, %zu allocated\n",
+          label, side->size, side->count, fill, side->allocated);
+}
@@ -0,0 +1,59 @@
+// One side of the book as a list of sorted, cache-sized chunks.
+//
+// Chunks hold at most CHUNK_CAPACITY entries and are kept in order, so
+// the side as a whole is sorted and a query just walks the chunks. An
+// insertion finds its chunk by binary search over the chunks' last
+// entries, then memmoves the tail of that one chunk; a full chunk is
+// split in two first. A removal memmoves within its chunk and merges
+// neighbouring chunks once they are both small.
+//
+// Entries are compared on (price, quantity, order_id), so every order has
+// a unique position. The buy side stores price and quantity negated,
+// which lets both sides sort ascending in the order they are printed.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include "order.h"
+#include "orderbook.h"
+
+#define CHUNK_CAPACITY 128
+
+typedef struct {
+  int price;    // negated on the buy side
+  int quantity; // negated on the buy side
+  int order_id;
+} ChunkEntry;
+
+typedef struct Chunk {
+  size_t size;
+  struct Chunk *next_free;
+  ChunkEntry entries[CHUNK_CAPACITY];
+} Chunk;
+
+typedef struct {
+  Chunk **chunks;   // in sort order
+  ChunkEntry *last; // last[i] is the last entry of chunks[i]
+  size_t count;     // chunks in use
+  size_t capacity;  // length of chunks and last
+  size_t size;      // orders on this side
+
+  OrderType type;
+  Chunk *free_chunks; // released chunks, reused before allocating
+  size_t allocated;   // chunks ever allocated
+} ChunkedOrders;
+
+void init_chunked_orders(ChunkedOrders *side, OrderType type);
+void free_chunked_orders(ChunkedOrders *side);
+void insert_chunked_order(ChunkedOrders *side, const Order *order);
+// The order must be on this side with the price and quantity it was
+// inserted with.
+void remove_chunked_order(ChunkedOrders *side, const Order *order);
+// Visit the orders, best first, as Orders built on the fly
+void visit_chunked_orders(const ChunkedOrders *side, ObVisitor visit,
+                          void *ctx);
+void print_chunked_stats(const ChunkedOrders *side, const char *label,
+                         FILE *out);
@@ -0,0 +1,64 @@
+#include <stdio.h>
+
+#include "chunked_orders.h"
+#include "driver.h"
+#include "order.h"
+#include "orderbook.h"
+#include "sorted_sides.h"
+
+// A port of rust/blocks_and_table: both sides are kept sorted at all
+// times as lists of sorted chunks behind a single id index (see
+// sorted_sides.h).
+
+// ---------- Side Operations ----------
+
+static void init_side(void *side, OrderType type) {
+  init_chunked_orders(side, type);
+}
+static void free_side(void *side) { free_chunked_orders(side); }
+static void insert_side(void *side, const Order *order) {
+  insert_chunked_order(side, order);
+}
+static void remove_side(void *side, const Order *order) {
+  remove_chunked_order(side, order);
+}
+static void visit_side(const void *side, ObVisitor visit, void *ctx) {
+  visit_chunked_orders(side, visit, ctx);
+}
+static void print_side_stats(const void *side, const char *label,
+                             FILE *out) {
+  print_chunked_stats(side, label, out);
+}
+
+static const SortedSideOps chunked_sides = {
+    .side_size = sizeof(ChunkedOrders),
+    .init = init_side,
+    .free = free_side,
+    .insert = insert_side,
+    .remove = remove_side,
+    .visit = visit_side,
+    .print_stats = print_side_stats,
+    .labels = {[ORDER_BUY] = "buy chunks:", [ORDER_SELL] = "sell chunks:"},
+};
+
+// ---------- Backend ----------
+
+static void *init_book(void) { return init_sorted_sides(&chunked_sides); }
+
+static const ObBackend chunked_backend = {
+    .name = "chunked_sorted",
+    .init_book = init_book,
+    .free_book = free_sorted_sides,
+    .create = sorted_sides_create,
+    .update = sorted_sides_update,
+    .remove = sorted_sides_remove,
+    .query = sorted_sides_query,
+    .print_stats = print_sorted_sides_stats,
+    .prefetch = sorted_sides_prefetch,
+};
+
+// ---------- Main ----------
+
+int main(int argc, char *argv[]) {
+  return run_driver(argc, argv, &chunked_backend);
+}
@@ -0,0 +1,173 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "arena.h"
+
+#define HUGE_PAGE_SIZE ((size_t)2 << 20)
+#define MIN_SLICE ((size_t)1 << 30) // address space only, unless touched
+#define BYTES_PER_ORDER 64 // generous: covers a pointer, a slot and an Order
+#define HUGETLB_SLICES 8 // one book's buffers: sides, index, slots, caches
+
+typedef enum { BACKING_NONE, BACKING_PAGES, BACKING_THP, BACKING_HUGETLB } Backing;
+
+static struct {
+  char *base;
+  size_t slice_size;
+  unsigned slices;
+  uint32_t used; // bit i set while slice i is handed out, updated atomically
+  size_t high[ARENA_SLICES]; // bytes asked for in slice i since handed out
+  Backing backing;
+  size_t expected_orders;
+  size_t fallbacks; // buffers that had to go to malloc
+} arena;
+
+_Static_assert(ARENA_SLICES <= 32, "slice mask is 32 bits");
+_Static_assert(HUGETLB_SLICES <= ARENA_SLICES, "fewer huge page slices");
+
+// ---------- Setup ----------
+
+static size_t round_up(size_t n, size_t multiple) {
+  return (n + multiple - 1) / multiple * multiple;
+}
+
+static void *map_anonymous(size_t bytes, int extra_flags) {
+  void *p = mmap(NULL, bytes, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | extra_flags, -1, 0);
+  return p == MAP_FAILED ? NULL : p;
+}
+
+void init_arena(size_t expected_orders, bool huge_pages) {
+  arena.expected_orders = expected_orders;
+  if (!expected_orders && !huge_pages)
+    return;
+
+  size_t wanted = round_up(
+      (expected_orders ? expected_orders : 1 << 16) * BYTES_PER_ORDER,
+      HUGE_PAGE_SIZE);
+
+#ifdef MAP_HUGETLB
+  // Explicit huge pages are reserved when mapped, so the mapping fails
+  // cleanly if the pool is too small. Every page mapped is taken from
+  // the pool whether it is touched or not, so slices are only as large
+  // as the hint and there are only as many as one book fills; further
+  // buffers go to malloc.
+  if (huge_pages) {
+    arena.slice_size = wanted;
+    arena.slices = HUGETLB_SLICES;
+    arena.base = map_anonymous(wanted * HUGETLB_SLICES, MAP_HUGETLB);
+    if (arena.base) {
+      arena.backing = BACKING_HUGETLB;
+      return;
+    }
+  }
+#endif
+
+  // Normal pages: reserve generously, nothing is committed until touched
+  arena.slice_size = wanted > MIN_SLICE ? wanted : MIN_SLICE;
+  arena.slices = ARENA_SLICES;
+#ifdef MAP_NORESERVE
+  arena.base = map_anonymous(arena.slice_size * arena.slices, MAP_NORESERVE);
+#else
+  arena.base = map_anonymous(arena.slice_size * arena.slices, 0);
+#endif
+  if (!arena.base) {
+    perror("mmap arena (using malloc)");
+    return;
+  }
+  arena.backing = BACKING_PAGES;
+#ifdef MADV_HUGEPAGE
+  if (huge_pages && madvise(arena.base, arena.slice_size * arena.slices,
+                            MADV_HUGEPAGE) == 0)
+    arena.backing = BACKING_THP;
+#endif
+}
+
+size_t capacity_hint(size_t default_capacity) {
+  return arena.expected_orders ? arena.expected_orders : default_capacity;
+}
+
+// ---------- Allocation ----------
+
+static bool in_arena(const void *data) {
+  const char *p = data;
+  return arena.base && p >= arena.base &&
+         p < arena.base + arena.slice_size * arena.slices;
+}
+
+static void *checked(void *p) {
+  if (!p) {
+    perror("malloc");
+    exit(1);
+  }
+  return p;
+}
+
+// Books on different threads (--batch) share the arena, so slices are
+// claimed and released with atomic operations on the mask
+void *arena_alloc(size_t bytes) {
+  uint32_t all = (uint32_t)((UINT64_C(1) << arena.slices) - 1);
+  if (arena.base && bytes <= arena.slice_size) {
+    uint32_t used = __atomic_load_n(&arena.used, __ATOMIC_RELAXED);
+    while (used != all) {
+      unsigned slice = (unsigned)__builtin_ctz(~used);
+      if (__atomic_compare_exchange_n(&arena.used, &used,
+                                      used | UINT32_C(1) << slice, false,
+                                      __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        arena.high[slice] = bytes;
+        return arena.base + slice * arena.slice_size;
+      }
+    }
+  }
+  if (arena.base)
+    __atomic_fetch_add(&arena.fallbacks, 1, __ATOMIC_RELAXED);
+  return checked(malloc(bytes));
+}
+
+void *arena_grow(void *data, size_t old_bytes, size_t new_bytes) {
+  if (!in_arena(data))
+    return checked(realloc(data, new_bytes));
+  if (new_bytes <= arena.slice_size) {
+    size_t slice = (size_t)((char *)data - arena.base) / arena.slice_size;
+    if (new_bytes > arena.high[slice])
+      arena.high[slice] = new_bytes;
+    return data;
+  }
+
+  // Outgrew its slice: move to the heap for good
+  __atomic_fetch_add(&arena.fallbacks, 1, __ATOMIC_RELAXED);
+  void *moved = checked(malloc(new_bytes));
+  memcpy(moved, data, old_bytes);
+  arena_free(data);
+  return moved;
+}
+
+void arena_free(void *data) {
+  if (!in_arena(data)) {
+    free(data);
+    return;
+  }
+  size_t slice = (size_t)((char *)data - arena.base) / arena.slice_size;
+  // Hand back the pages the buffer can have touched, but keep the address
+  // space. Whole huge pages, which hugetlb mappings require.
+  size_t touched = round_up(arena.high[slice], HUGE_PAGE_SIZE);
+  if (touched > arena.slice_size)
+    touched = arena.slice_size;
+  madvise(data, touched, MADV_DONTNEED);
+  __atomic_fetch_and(&arena.used, ~(UINT32_C(1) << slice), __ATOMIC_RELEASE);
+}
+
+// ---------- Statistics ----------
+
+void print_arena_stats(FILE *out) {
+  static const char *backing[] = {"malloc", "normal pages",
+                                  "transparent huge pages", "huge pages"};
+  if (!arena.expected_orders && arena.backing == BACKING_NONE)
+    return;
+  fprintf(out, "arena:         %s, %d of %u slices of %zu MiB in use, "
+               "%zu heap fallbacks\n",
+          backing[arena.backing], __builtin_popcount(arena.used),
+          arena.slices, arena.slice_size >> 20, arena.fallbacks);
+}
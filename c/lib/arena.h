@@ -0,0 +1,41 @@
+// Shared arena for the growable containers, plus the capacity hint.
+//
+// init_arena reserves a large range of virtual address space up front
+// and splits it into ARENA_SLICES equal slices (fewer with explicit huge
+// pages, which are taken from the pool as soon as they are mapped).
+// arena_alloc hands each growable buffer a slice of its own, so
+// arena_grow can extend it in place, with no copying and no realloc;
+// pages are only faulted in as the buffer reaches them. When asked, the
+// arena is backed by explicit huge pages (MAP_HUGETLB) if the system has
+// enough of them reserved, or else by transparent huge pages (madvise
+// MADV_HUGEPAGE), or else by normal pages.
+//
+// Until init_arena is called with a hint or huge pages, and whenever the
+// arena has no free slice or a buffer outgrows its slice, the functions
+// fall back to malloc, realloc and free, so containers can use them
+// unconditionally.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#define ARENA_SLICES 32
+
+// expected_orders is the --expected-orders hint, or 0 for none
+void init_arena(size_t expected_orders, bool huge_pages);
+// Initial capacity for a container: the hint if one was given, else the
+// container's own default. Every container gets the whole hint, the
+// per-side arrays included, since any one of them may end up holding
+// most of the orders. The capacity is reserved, not committed: a buffer
+// only costs the pages it touches, which for most containers is how far
+// they fill. Most arrays indexed by order id initialise every entry, so
+// they touch their whole capacity up front.
+size_t capacity_hint(size_t default_capacity);
+
+void *arena_alloc(size_t bytes);
+// Like realloc, but in place for buffers inside the arena
+void *arena_grow(void *data, size_t old_bytes, size_t new_bytes);
+void arena_free(void *data);
+void print_arena_stats(FILE *out);
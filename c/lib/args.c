@@ -3,22 +3,101 @@
 #include <string.h>
 
 #include "args.h"
+#include "parallel_format.h"
 
 void parse_args(Config *cfg, int argc, char *argv[]) {
   cfg->silent = false;
+  cfg->delta = false;
+  cfg->line_cache = false;
+  cfg->format_threads = 0;
+  cfg->format_threshold = 100000;
+  cfg->compact = false;
+  cfg->prefetch = 0;
+  cfg->binary = false;
+  cfg->latency = false;
+  cfg->stats = false;
+  cfg->stats_every = 0;
+  cfg->expected_orders = 0;
+  cfg->huge_pages = false;
+  cfg->async_io = false;
   cfg->input_file = NULL;
+  cfg->shm_name = NULL;
+  cfg->busy_poll = false;
+  cfg->listen_path = NULL;
+  cfg->batch_file = NULL;
+  cfg->threads = 0;
 
   for (int i = 1; i < argc; i++) {
     if (strcmp(argv[i], "--silent") == 0 || strcmp(argv[i], "-s") == 0) {
       cfg->silent = true;
+    } else if (strcmp(argv[i], "--delta") == 0) {
+      cfg->delta = true;
+    } else if (strcmp(argv[i], "--line-cache") == 0) {
+      cfg->line_cache = true;
+    } else if (strcmp(argv[i], "--compact") == 0) {
+      cfg->compact = true;
+    } else if (strcmp(argv[i], "--prefetch") == 0 && i + 1 < argc) {
+      cfg->prefetch = atol(argv[++i]);
+    } else if (strcmp(argv[i], "--format-threads") == 0 && i + 1 < argc) {
+      cfg->format_threads = atol(argv[++i]);
+      if (cfg->format_threads < 0 || cfg->format_threads > FORMAT_MAX_THREADS) {
+        fprintf(stderr, "--format-threads must be between 0 and %d\n",
+                FORMAT_MAX_THREADS);
+        exit(EXIT_FAILURE);
+      }
+    } else if (strcmp(argv[i], "--format-threshold") == 0 && i + 1 < argc) {
+      cfg->format_threshold = atol(argv[++i]);
+    } else if (strcmp(argv[i], "--binary") == 0 ||
+               strcmp(argv[i], "-b") == 0) {
+      cfg->binary = true;
+    } else if (strcmp(argv[i], "--latency") == 0) {
+      cfg->latency = true;
+    } else if (strcmp(argv[i], "--stats") == 0) {
+      cfg->stats = true;
+    } else if (strcmp(argv[i], "--stats-every") == 0 && i + 1 < argc) {
+      cfg->stats = true;
+      cfg->stats_every = atol(argv[++i]);
+    } else if (strcmp(argv[i], "--expected-orders") == 0 && i + 1 < argc) {
+      cfg->expected_orders = atol(argv[++i]);
+    } else if (strcmp(argv[i], "--huge-pages") == 0) {
+      cfg->huge_pages = true;
+    } else if (strcmp(argv[i], "--async-io") == 0) {
+      cfg->async_io = true;
     } else if ((strcmp(argv[i], "--input") == 0 ||
                 strcmp(argv[i], "-i") == 0) &&
                i + 1 < argc) {
       cfg->input_file = argv[++i];
+    } else if (strcmp(argv[i], "--shm") == 0 && i + 1 < argc) {
+      cfg->shm_name = argv[++i];
+    } else if (strcmp(argv[i], "--busy-poll") == 0) {
+      cfg->busy_poll = true;
+    } else if (strcmp(argv[i], "--listen") == 0 && i + 1 < argc) {
+      cfg->listen_path = argv[++i];
+    } else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+      cfg->batch_file = argv[++i];
+    } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+      cfg->threads = atol(argv[++i]);
     } else {
       fprintf(stderr, "Unknown argument: %s\n", argv[i]);
-      fprintf(stderr, "Usage: %s [--silent|-s] [--input|-i <file>]\n", argv[0]);
+      fprintf(stderr,
+              "Usage: %s [--silent|-s] [--input|-i <file>] [--binary|-b]\n"
+              "          [--delta] [--line-cache] [--latency] [--stats]\n"
+              "          [--format-threads <n> [--format-threshold <n>]]\n"
+              "          (--format-threads excludes --delta and --line-cache)\n"
+              "          [--stats-every <n>] [--expected-orders <n>]\n"
+              "          [--huge-pages] [--async-io] [--compact]\n"
+              "          [--prefetch <events>]\n"
+              "          [--shm <name> [--busy-poll]] [--listen <socket>]\n"
+              "          [--batch <list-file> [--threads <n>]]\n",
+              argv[0]);
       exit(EXIT_FAILURE);
     }
   }
+
+  // --delta and --line-cache write queries their own way
+  if (cfg->format_threads > 0 && (cfg->delta || cfg->line_cache)) {
+    fprintf(stderr, "--format-threads cannot be combined with %s\n",
+            cfg->delta ? "--delta" : "--line-cache");
+    exit(EXIT_FAILURE);
+  }
 }
@@ -4,7 +4,25 @@
 
 typedef struct {
   bool silent;
+  bool delta;   // print queries as changes since the previous query
+  bool line_cache; // print queries from preformatted per-order lines
+  long format_threads;   // format large query results on this many threads
+  long format_threshold; // ... when they have at least this many orders
+  bool compact; // apply only the net effect of the events between queries
+  long prefetch; // read events this far ahead and prefetch their orders
+  bool binary;  // input is BinaryEvent records rather than text
+  bool latency; // per-event latency histograms on stderr at exit
+  bool stats;   // engine internals counters on stderr at exit
+  long stats_every; // ... and every this many events, if positive
+  long expected_orders; // capacity hint for containers, 0 if none
+  bool huge_pages;      // back the container arena with huge pages
+  bool async_io;        // read input and write output asynchronously
   const char *input_file;
+  const char *shm_name; // read events from this shared-memory ring
+  bool busy_poll;       // ... spinning instead of sleeping when it is empty
+  const char *listen_path; // serve the book on this Unix socket
+  const char *batch_file;  // replay every input listed in this file
+  long threads;            // ... on this many threads, 0 for one per CPU
 } Config;
 
 void parse_args(Config *cfg, int argc, char *argv[]);
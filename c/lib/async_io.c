@@ -0,0 +1,505 @@
+#define _GNU_SOURCE // fopencookie
+
+#include "async_io.h"
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#define HAVE_IO_URING 1
+#endif
+
+#define INPUT_CHUNKS 4
+#define INPUT_CHUNK_SIZE (1 << 20)
+#define OUTPUT_BUFFERS 4
+#define OUTPUT_BUFFER_SIZE (1 << 20)
+
+static struct {
+  bool used;
+  bool uring;
+  unsigned long long reads, writes;
+  unsigned long long input_waits;  // parser waited for a read
+  unsigned long long output_waits; // engine waited for a free buffer
+} io_stats;
+
+static void *xmalloc(size_t bytes, const char *what) {
+  void *p = malloc(bytes);
+  if (!p) {
+    perror(what);
+    exit(EXIT_FAILURE);
+  }
+  return p;
+}
+
+static void die_io(const char *what, int err) {
+  fprintf(stderr, "%s: %s\n", what, strerror(err));
+  exit(EXIT_FAILURE);
+}
+
+// ---------- io_uring ----------
+
+// Just enough of an io_uring to keep a handful of reads or writes in
+// flight: one submission per call to uring_submit and completions reaped
+// straight from the shared ring.
+
+#if HAVE_IO_URING
+
+typedef struct {
+  int fd;
+  unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+  unsigned *cq_head, *cq_tail, *cq_mask;
+  struct io_uring_sqe *sqes;
+  struct io_uring_cqe *cqes;
+  void *sq_ring, *cq_ring;
+  size_t sq_ring_size, cq_ring_size, sqes_size;
+  unsigned pending; // prepared but not yet submitted
+} Uring;
+
+static bool uring_init(Uring *u, unsigned entries) {
+  struct io_uring_params p;
+  memset(&p, 0, sizeof p);
+  memset(u, 0, sizeof *u);
+  u->fd = (int)syscall(__NR_io_uring_setup, entries, &p);
+  if (u->fd < 0)
+    return false;
+  // Writes with offset -1 need the file position support of 5.6
+  if (!(p.features & IORING_FEAT_SINGLE_MMAP) ||
+      !(p.features & IORING_FEAT_RW_CUR_POS)) {
+    close(u->fd);
+    return false;
+  }
+
+  u->sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+  u->cq_ring_size =
+      p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+  if (u->cq_ring_size > u->sq_ring_size)
+    u->sq_ring_size = u->cq_ring_size;
+  u->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+
+  u->sq_ring = mmap(NULL, u->sq_ring_size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, u->fd, IORING_OFF_SQ_RING);
+  u->sqes = mmap(NULL, u->sqes_size, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_POPULATE, u->fd, IORING_OFF_SQES);
+  if (u->sq_ring == MAP_FAILED || u->sqes == MAP_FAILED) {
+    close(u->fd);
+    return false;
+  }
+  u->cq_ring = u->sq_ring; // one mapping for both rings
+
+  char *sq = u->sq_ring, *cq = u->cq_ring;
+  u->sq_head = (unsigned *)(sq + p.sq_off.head);
+  u->sq_tail = (unsigned *)(sq + p.sq_off.tail);
+  u->sq_mask = (unsigned *)(sq + p.sq_off.ring_mask);
+  u->sq_array = (unsigned *)(sq + p.sq_off.array);
+  u->cq_head = (unsigned *)(cq + p.cq_off.head);
+  u->cq_tail = (unsigned *)(cq + p.cq_off.tail);
+  u->cq_mask = (unsigned *)(cq + p.cq_off.ring_mask);
+  u->cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+  return true;
+}
+
+static void uring_free(Uring *u) {
+  munmap(u->sqes, u->sqes_size);
+  munmap(u->sq_ring, u->sq_ring_size);
+  close(u->fd);
+}
+
+// Queue a read or write; the caller never has more in flight than the
+// ring has entries
+static void uring_prep(Uring *u, uint8_t opcode, int fd, void *buf,
+                       unsigned len, int64_t offset, uint64_t user_data) {
+  unsigned tail = *u->sq_tail;
+  unsigned index = tail & *u->sq_mask;
+  struct io_uring_sqe *sqe = &u->sqes[index];
+  memset(sqe, 0, sizeof *sqe);
+  sqe->opcode = opcode;
+  sqe->fd = fd;
+  sqe->addr = (uint64_t)(uintptr_t)buf;
+  sqe->len = len;
+  sqe->off = (uint64_t)offset;
+  sqe->user_data = user_data;
+  u->sq_array[index] = index;
+  __atomic_store_n(u->sq_tail, tail + 1, __ATOMIC_RELEASE);
+  u->pending++;
+}
+
+// Submit what was prepared and, if wait, block for one completion
+static void uring_submit(Uring *u, bool wait) {
+  if (!u->pending && !wait)
+    return;
+  for (;;) {
+    long r = syscall(__NR_io_uring_enter, u->fd, u->pending, wait ? 1 : 0,
+                     wait ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+    if (r >= 0) {
+      u->pending -= (unsigned)r;
+      return;
+    }
+    if (errno != EINTR)
+      die_io("io_uring_enter", errno);
+  }
+}
+
+static bool uring_reap(Uring *u, uint64_t *user_data, int *res) {
+  unsigned head = *u->cq_head;
+  if (head == __atomic_load_n(u->cq_tail, __ATOMIC_ACQUIRE))
+    return false;
+  struct io_uring_cqe *cqe = &u->cqes[head & *u->cq_mask];
+  *user_data = cqe->user_data;
+  *res = cqe->res;
+  __atomic_store_n(u->cq_head, head + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+#endif
+
+// ---------- Input ----------
+
+// Chunk number n goes in buffer n % INPUT_CHUNKS. On a regular file it
+// is read from base + n * INPUT_CHUNK_SIZE, so reads can complete in any
+// order; on anything else from the current position, one at a time.
+
+struct AsyncInput {
+  int fd;
+  bool seekable;
+  bool uring;
+  bool eof;
+  off_t base;
+  unsigned next_chunk; // next chunk handed to the parser
+  unsigned submitted;  // chunks whose reads have been queued
+  unsigned in_flight;
+  int result[INPUT_CHUNKS];
+  bool done[INPUT_CHUNKS];
+  char *buffers;
+#if HAVE_IO_URING
+  Uring ring;
+#endif
+};
+
+static inline char *chunk_buffer(AsyncInput *in, unsigned chunk) {
+  return in->buffers + (size_t)(chunk % INPUT_CHUNKS) * INPUT_CHUNK_SIZE;
+}
+
+AsyncInput *async_input_open(int fd) {
+  AsyncInput *in = xmalloc(sizeof *in, "malloc async input");
+  memset(in, 0, sizeof *in);
+  in->fd = fd;
+  in->buffers = xmalloc((size_t)INPUT_CHUNKS * INPUT_CHUNK_SIZE,
+                        "malloc input buffers");
+  struct stat st;
+  in->seekable = fstat(fd, &st) == 0 && S_ISREG(st.st_mode);
+  in->base = in->seekable ? lseek(fd, 0, SEEK_CUR) : 0;
+  io_stats.used = true;
+#if HAVE_IO_URING
+  in->uring = uring_init(&in->ring, INPUT_CHUNKS);
+  io_stats.uring = in->uring;
+#endif
+  return in;
+}
+
+#if HAVE_IO_URING
+static void submit_read(AsyncInput *in) {
+  unsigned chunk = in->submitted++;
+  in->done[chunk % INPUT_CHUNKS] = false;
+  uring_prep(&in->ring, IORING_OP_READ, in->fd, chunk_buffer(in, chunk),
+             INPUT_CHUNK_SIZE,
+             in->seekable ? in->base + (off_t)chunk * INPUT_CHUNK_SIZE : -1,
+             chunk);
+  in->in_flight++;
+  io_stats.reads++;
+}
+
+static void reap_reads(AsyncInput *in) {
+  uint64_t chunk;
+  int res;
+  while (uring_reap(&in->ring, &chunk, &res)) {
+    in->result[chunk % INPUT_CHUNKS] = res;
+    in->done[chunk % INPUT_CHUNKS] = true;
+    in->in_flight--;
+  }
+}
+
+// Keep reads in flight ahead of the parser: into every buffer but the
+// one it is about to get on a file, into the next one otherwise. Called
+// as the parser asks for the next chunk, when the buffer it had is free.
+static void fill_pipeline(AsyncInput *in) {
+  unsigned limit = in->seekable ? in->next_chunk + INPUT_CHUNKS
+                                : in->next_chunk + 1;
+  while (!in->eof && in->submitted < limit &&
+         (in->seekable || in->in_flight == 0))
+    submit_read(in);
+  uring_submit(&in->ring, false);
+}
+
+static int wait_for_chunk(AsyncInput *in, unsigned chunk) {
+  reap_reads(in);
+  if (!in->done[chunk % INPUT_CHUNKS]) {
+    io_stats.input_waits++;
+    do {
+      uring_submit(&in->ring, true);
+      reap_reads(in);
+    } while (!in->done[chunk % INPUT_CHUNKS]);
+  }
+  return in->result[chunk % INPUT_CHUNKS];
+}
+#endif
+
+static ssize_t read_fully(int fd, char *buf, size_t len, off_t offset,
+                          bool seekable) {
+  size_t got = 0;
+  while (got < len) {
+    ssize_t n = seekable ? pread(fd, buf + got, len - got, offset + got)
+                         : read(fd, buf + got, len - got);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n < 0)
+      return n;
+    if (n == 0 || !seekable)
+      return (ssize_t)(got + (size_t)n); // a pipe hands over what it has
+    got += (size_t)n;
+  }
+  return (ssize_t)got;
+}
+
+size_t async_input_next(AsyncInput *in, char **data) {
+  if (in->eof)
+    return 0;
+  unsigned chunk = in->next_chunk;
+  char *buf = chunk_buffer(in, chunk);
+  ssize_t n;
+#if HAVE_IO_URING
+  if (in->uring) {
+    // The buffer of the previous chunk is free again
+    fill_pipeline(in);
+    n = wait_for_chunk(in, chunk);
+    if (n < 0)
+      die_io("read", -(int)n);
+    // A short read inside a file leaves a gap before the next chunk
+    if (in->seekable && n > 0 && n < INPUT_CHUNK_SIZE) {
+      ssize_t rest = read_fully(
+          in->fd, buf + n, INPUT_CHUNK_SIZE - (size_t)n,
+          in->base + (off_t)chunk * INPUT_CHUNK_SIZE + n, true);
+      if (rest < 0)
+        die_io("read", errno);
+      n += rest;
+    }
+  } else
+#endif
+  {
+    n = read_fully(in->fd, buf, INPUT_CHUNK_SIZE,
+                   in->base + (off_t)chunk * INPUT_CHUNK_SIZE, in->seekable);
+    if (n < 0)
+      die_io("read", errno);
+    io_stats.reads++;
+  }
+
+  in->next_chunk++;
+  if (n == 0) {
+    in->eof = true;
+    return 0;
+  }
+#if HAVE_IO_URING
+  // On a pipe, start reading the next chunk while this one is parsed
+  if (in->uring && !in->seekable)
+    fill_pipeline(in);
+#endif
+  *data = buf;
+  return (size_t)n;
+}
+
+void async_input_close(AsyncInput *in) {
+#if HAVE_IO_URING
+  if (in->uring) {
+    // The kernel may still be writing into the buffers
+    uring_submit(&in->ring, false);
+    while (in->in_flight > 0) {
+      uring_submit(&in->ring, true);
+      reap_reads(in);
+    }
+    uring_free(&in->ring);
+  }
+#endif
+  free(in->buffers);
+  free(in);
+}
+
+// ---------- Output ----------
+
+// Buffers are filled in turn. Filled buffers are written in order, one
+// write in flight at a time, since concurrent writes to a pipe or at the
+// file position are not ordered.
+
+static struct {
+  FILE *stdout_before;
+  FILE *stream;
+  int fd;
+  bool uring;
+  char *buffers;
+  size_t size[OUTPUT_BUFFERS];
+  unsigned filling; // buffer number being filled
+  unsigned writing; // oldest buffer not yet fully written
+  size_t written;   // bytes of it already written
+  bool in_flight;
+#if HAVE_IO_URING
+  Uring ring;
+#endif
+} out;
+
+static inline char *out_buffer(unsigned n) {
+  return out.buffers + (size_t)(n % OUTPUT_BUFFERS) * OUTPUT_BUFFER_SIZE;
+}
+
+static void write_done(size_t n) {
+  out.written += n;
+  if (out.written == out.size[out.writing % OUTPUT_BUFFERS]) {
+    out.writing++;
+    out.written = 0;
+  }
+}
+
+#if HAVE_IO_URING
+static void reap_write(void) {
+  uint64_t tag;
+  int res;
+  if (out.in_flight && uring_reap(&out.ring, &tag, &res)) {
+    if (res < 0)
+      die_io("write", -res);
+    out.in_flight = false;
+    write_done((size_t)res);
+  }
+}
+
+static void start_write(void) {
+  if (out.in_flight || out.writing == out.filling)
+    return;
+  unsigned n = out.writing;
+  uring_prep(&out.ring, IORING_OP_WRITE, out.fd, out_buffer(n) + out.written,
+             (unsigned)(out.size[n % OUTPUT_BUFFERS] - out.written), -1, n);
+  uring_submit(&out.ring, false);
+  out.in_flight = true;
+  io_stats.writes++;
+}
+#endif
+
+// Move the writes along. With wait, block until the write in flight
+// completes.
+static void pump_output(bool wait) {
+#if HAVE_IO_URING
+  if (out.uring) {
+    reap_write();
+    if (wait && out.in_flight) {
+      uring_submit(&out.ring, true);
+      reap_write();
+    }
+    start_write();
+    return;
+  }
+#endif
+  (void)wait;
+  while (out.writing != out.filling) {
+    unsigned n = out.writing;
+    ssize_t r = write(out.fd, out_buffer(n) + out.written,
+                      out.size[n % OUTPUT_BUFFERS] - out.written);
+    if (r < 0 && errno == EINTR)
+      continue;
+    if (r < 0)
+      die_io("write", errno);
+    write_done((size_t)r);
+    io_stats.writes++;
+  }
+}
+
+// Hand the buffer being filled over to the writer and wait for the next
+// one to be free
+static void seal_buffer(void) {
+  if (out.size[out.filling % OUTPUT_BUFFERS] == 0)
+    return;
+  out.filling++;
+  pump_output(false);
+  if (out.filling - out.writing == OUTPUT_BUFFERS) {
+    io_stats.output_waits++;
+    while (out.filling - out.writing == OUTPUT_BUFFERS)
+      pump_output(true);
+  }
+  out.size[out.filling % OUTPUT_BUFFERS] = 0;
+}
+
+#if defined(__GLIBC__)
+static ssize_t cookie_write(void *cookie, const char *data, size_t len) {
+  (void)cookie;
+  size_t left = len;
+  while (left > 0) {
+    size_t *size = &out.size[out.filling % OUTPUT_BUFFERS];
+    size_t take = OUTPUT_BUFFER_SIZE - *size;
+    if (take > left)
+      take = left;
+    memcpy(out_buffer(out.filling) + *size, data, take);
+    *size += take;
+    data += take;
+    left -= take;
+    if (*size == OUTPUT_BUFFER_SIZE)
+      seal_buffer();
+  }
+  return (ssize_t)len;
+}
+
+void async_output_begin(void) {
+  cookie_io_functions_t funcs = {.write = cookie_write};
+  fflush(stdout);
+  out.fd = fileno(stdout);
+  out.buffers = xmalloc((size_t)OUTPUT_BUFFERS * OUTPUT_BUFFER_SIZE,
+                        "malloc output buffers");
+  out.stream = fopencookie(NULL, "w", funcs);
+  if (!out.stream) {
+    perror("fopencookie");
+    exit(EXIT_FAILURE);
+  }
+  io_stats.used = true;
+#if HAVE_IO_URING
+  out.uring = uring_init(&out.ring, 2);
+  io_stats.uring = io_stats.uring || out.uring;
+#endif
+  out.stdout_before = stdout;
+  stdout = out.stream;
+  // Engines exit on bad input; what they printed must still go out
+  atexit(async_output_end);
+}
+
+void async_output_end(void) {
+  if (!out.stream)
+    return;
+  fflush(out.stream);
+  seal_buffer();
+  while (out.writing != out.filling)
+    pump_output(true);
+  stdout = out.stdout_before;
+  fclose(out.stream);
+#if HAVE_IO_URING
+  if (out.uring)
+    uring_free(&out.ring);
+#endif
+  free(out.buffers);
+  memset(&out, 0, sizeof out);
+}
+#else
+void async_output_begin(void) {}
+void async_output_end(void) {}
+#endif
+
+void print_async_io_stats(FILE *f) {
+  if (!io_stats.used)
+    return;
+  fprintf(f,
+          "async io:      %s, %llu reads (%llu waited), "
+          "%llu writes (%llu waits for a buffer)\n",
+          io_stats.uring ? "io_uring" : "read/write", io_stats.reads,
+          io_stats.input_waits, io_stats.writes, io_stats.output_waits);
+}
@@ -0,0 +1,35 @@
+// Asynchronous input and output for the drivers (--async-io).
+//
+// AsyncInput reads a file descriptor through a few large buffers. On a
+// regular file every buffer that is not being parsed has a read in
+// flight, so the parser only waits when it outruns the disk; on a pipe
+// one read is in flight ahead of the parser. async_output_begin routes
+// stdout through large buffers that are written one at a time while the
+// engine fills the next, so output only blocks when every buffer is
+// waiting for the device.
+//
+// Both use io_uring, driven through the raw system calls, when the
+// kernel offers it. Otherwise, or off Linux, they fall back to plain
+// read and write calls on the same large buffers.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdio.h>
+
+typedef struct AsyncInput AsyncInput;
+
+AsyncInput *async_input_open(int fd);
+// Point *data at the next chunk of input and return its length, or 0 at
+// the end. The chunk is the caller's to read and modify until the next
+// call.
+size_t async_input_next(AsyncInput *in, char **data);
+void async_input_close(AsyncInput *in);
+
+// Send everything printed to stdout through the asynchronous writer,
+// until async_output_end flushes it and restores stdout. Needs glibc's
+// fopencookie; elsewhere stdout is left alone.
+void async_output_begin(void);
+void async_output_end(void);
+
+void print_async_io_stats(FILE *out);
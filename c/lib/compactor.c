@@ -0,0 +1,166 @@
+#include "compactor.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+
+#define COMPACT_DEAD (-2) // never created, or removed
+#define COMPACT_LIVE (-1) // in the book, nothing pending
+
+// ---------- Initialization and Cleanup ----------
+
+void init_compactor(Compactor *c, EventSink apply, void (*skip_id)(void *ctx),
+                    void *ctx) {
+  c->apply = apply;
+  c->skip_id = skip_id;
+  c->ctx = ctx;
+  c->ids = capacity_hint(1024);
+  c->state = arena_alloc(c->ids * sizeof *c->state);
+  c->capacity = 256;
+  c->pending = malloc(c->capacity * sizeof *c->pending);
+  if (!c->state || !c->pending) {
+    perror("malloc compactor");
+    exit(EXIT_FAILURE);
+  }
+  for (size_t i = 0; i < c->ids; i++)
+    c->state[i] = COMPACT_DEAD;
+  c->next_id = 0;
+  c->size = 0;
+  c->events_in = c->events_applied = 0;
+  c->cancelled = c->merged = c->dropped = 0;
+}
+
+void free_compactor(Compactor *c) {
+  arena_free(c->state);
+  free(c->pending);
+}
+
+// ---------- Buffering ----------
+
+// NULL for ids that were never created
+static int32_t *state_of(Compactor *c, int order_id) {
+  if (order_id < 0 || order_id >= c->next_id)
+    return NULL;
+  return &c->state[order_id];
+}
+
+static int32_t push_pending(Compactor *c, const Event *event, int order_id) {
+  if (c->size == c->capacity) {
+    c->capacity *= 2;
+    c->pending = realloc(c->pending, c->capacity * sizeof *c->pending);
+    if (!c->pending) {
+      perror("realloc compactor");
+      exit(EXIT_FAILURE);
+    }
+  }
+  c->pending[c->size] =
+      (PendingEvent){.event = *event, .order_id = order_id, .cancelled = false};
+  return (int32_t)c->size++;
+}
+
+static void compact_create(Compactor *c, const Event *event) {
+  int order_id = c->next_id++;
+  if ((size_t)order_id >= c->ids) {
+    size_t ids = 2 * c->ids;
+    c->state = arena_grow(c->state, c->ids * sizeof *c->state,
+                          ids * sizeof *c->state);
+    for (size_t i = c->ids; i < ids; i++)
+      c->state[i] = COMPACT_DEAD;
+    c->ids = ids;
+  }
+  c->state[order_id] = push_pending(c, event, order_id);
+}
+
+static void compact_update(Compactor *c, const Event *event) {
+  int order_id = event->data.update.order_id;
+  int32_t *state = state_of(c, order_id);
+  if (!state || *state == COMPACT_DEAD) {
+    c->dropped++;
+  } else if (*state == COMPACT_LIVE) {
+    *state = push_pending(c, event, order_id);
+  } else {
+    // A pending CREATE takes the new price, a pending UPDATE is replaced
+    PendingEvent *p = &c->pending[*state];
+    if (p->event.type == EVENT_CREATE)
+      p->event.data.create.price = event->data.update.price;
+    else
+      p->event.data.update.price = event->data.update.price;
+    c->merged++;
+  }
+}
+
+static void compact_remove(Compactor *c, const Event *event) {
+  int order_id = event->data.remove.order_id;
+  int32_t *state = state_of(c, order_id);
+  if (!state || *state == COMPACT_DEAD) {
+    c->dropped++;
+    return;
+  }
+  if (*state == COMPACT_LIVE) {
+    push_pending(c, event, order_id);
+  } else {
+    PendingEvent *p = &c->pending[*state];
+    if (p->event.type == EVENT_CREATE) {
+      p->cancelled = true;
+      c->cancelled++;
+    } else {
+      p->event = *event; // the REMOVE supersedes the UPDATE
+      c->merged++;
+    }
+  }
+  *state = COMPACT_DEAD;
+}
+
+// ---------- Applying ----------
+
+void flush_compactor(Compactor *c) {
+  for (size_t i = 0; i < c->size; i++) {
+    PendingEvent *p = &c->pending[i];
+    if (p->cancelled) {
+      c->skip_id(c->ctx);
+      continue;
+    }
+    c->apply(&p->event, c->ctx);
+    c->events_applied++;
+    if (p->event.type != EVENT_REMOVE)
+      c->state[p->order_id] = COMPACT_LIVE;
+  }
+  c->size = 0;
+}
+
+void compact_event(Compactor *c, const Event *event) {
+  switch (event->type) {
+  case EVENT_CREATE:
+    c->events_in++;
+    compact_create(c, event);
+    break;
+  case EVENT_UPDATE:
+    c->events_in++;
+    compact_update(c, event);
+    break;
+  case EVENT_REMOVE:
+    c->events_in++;
+    compact_remove(c, event);
+    break;
+  case EVENT_BIDS:
+  case EVENT_ASKS:
+    flush_compactor(c);
+    c->apply(event, c->ctx);
+    break;
+  }
+}
+
+// ---------- Statistics ----------
+
+void print_compactor_stats(const Compactor *c, FILE *out) {
+  fprintf(out,
+          "compaction: %llu order events in, %llu applied (ratio %.3f); "
+          "%llu create/remove pairs cancelled, %llu merged, %llu dropped\n",
+          (unsigned long long)c->events_in,
+          (unsigned long long)c->events_applied,
+          c->events_in ? (double)c->events_applied / (double)c->events_in
+                       : 1.0,
+          (unsigned long long)c->cancelled, (unsigned long long)c->merged,
+          (unsigned long long)c->dropped);
+}
@@ -0,0 +1,60 @@
+// Between-query event compaction (--compact).
+//
+// Only the book's state at a query can be observed, so the order events
+// between two queries can be reduced to their net effect before the
+// book sees them. The compactor buffers events up to the next BIDS or
+// ASKS and keeps, per order id, one pending event: a CREATE carrying the
+// order's latest price, an UPDATE with the last price of the window, or
+// a REMOVE. A CREATE removed again in the same window is cancelled, and
+// its id is skipped rather than created. Events on ids that are unknown
+// or no longer live are dropped. At a query the pending events are
+// applied in arrival order, then the query itself.
+//
+// The compactor follows liveness itself, one word per id ever created,
+// so it needs every event for the book to go through it.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "events.h"
+
+typedef void (*EventSink)(const Event *event, void *ctx);
+
+typedef struct {
+  Event event;
+  int order_id;
+  bool cancelled; // a CREATE whose order was removed in the same window
+} PendingEvent;
+
+typedef struct {
+  EventSink apply;            // net events and queries
+  void (*skip_id)(void *ctx); // the id of a cancelled CREATE
+  void *ctx;
+
+  int32_t *state; // by id: COMPACT_DEAD, COMPACT_LIVE or a pending index
+  size_t ids;     // length of state
+  int next_id;
+  PendingEvent *pending;
+  size_t size, capacity;
+
+  // Statistics
+  uint64_t events_in;      // order events received
+  uint64_t events_applied; // ... and passed on
+  uint64_t cancelled;      // CREATE+REMOVE pairs
+  uint64_t merged;         // UPDATEs folded into an earlier event
+  uint64_t dropped;        // events on unknown or dead ids
+} Compactor;
+
+void init_compactor(Compactor *c, EventSink apply, void (*skip_id)(void *ctx),
+                    void *ctx);
+void free_compactor(Compactor *c);
+
+void compact_event(Compactor *c, const Event *event);
+// Apply what is pending, as a query would (at the end of the input)
+void flush_compactor(Compactor *c);
+
+void print_compactor_stats(const Compactor *c, FILE *out);
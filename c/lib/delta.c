@@ -0,0 +1,73 @@
+#include "delta.h"
+
+#include "stats.h"
+
+void init_delta_side(DeltaSide *side) {
+  init_order_array(&side->last);
+  init_order_array(&side->view);
+}
+
+void free_delta_side(DeltaSide *side) {
+  free_order_array(&side->last);
+  free_order_array(&side->view);
+}
+
+void collect_delta(const Order *order, void *ctx) {
+  append_order(&((DeltaSide *)ctx)->view, *order);
+}
+
+// ---------- Merging ----------
+
+// Negative when a comes before b on this side: bids best (highest) price
+// first, asks lowest first, and quantity breaking ties the same way
+static int side_cmp(OrderType type, const Order *a, const Order *b) {
+  int c = a->price != b->price ? (a->price < b->price ? -1 : 1)
+                               : (a->quantity > b->quantity) -
+                                     (a->quantity < b->quantity);
+  return type == ORDER_BUY ? -c : c;
+}
+
+static void print_entry(FILE *out, char mark, const Order *order) {
+  engine_stats.bytes_written += fprintf(out, "\t%c ", mark);
+  print_order(out, order);
+}
+
+static void print_change(FILE *out, const Order *from, const Order *to) {
+  engine_stats.bytes_written +=
+      fprintf(out, "\t~ %s %d %d %d\n",
+              to->order_type == ORDER_BUY ? "Buy" : "Sell", to->price,
+              from->quantity, to->quantity);
+}
+
+void print_delta(DeltaSide *side, OrderType type, const char *header,
+                 FILE *out) {
+  const Order *old = side->last.data, *new = side->view.data;
+  size_t old_size = side->last.size, new_size = side->view.size;
+
+  if (old_size > 0 || new_size > 0) {
+    engine_stats.bytes_written += fprintf(out, "%s", header);
+    size_t i = 0, j = 0;
+    while (i < old_size && j < new_size) {
+      int c = side_cmp(type, &old[i], &new[j]);
+      if (c == 0) {
+        i++, j++;
+      } else if (old[i].price == new[j].price) {
+        print_change(out, &old[i++], &new[j++]);
+      } else if (c < 0) {
+        print_entry(out, '-', &old[i++]);
+      } else {
+        print_entry(out, '+', &new[j++]);
+      }
+    }
+    while (i < old_size)
+      print_entry(out, '-', &old[i++]);
+    while (j < new_size)
+      print_entry(out, '+', &new[j++]);
+    engine_stats.bytes_written += fprintf(out, "\n");
+  }
+
+  OrderArray last = side->last;
+  side->last = side->view;
+  side->view = last;
+  side->view.size = 0;
+}
@@ -0,0 +1,33 @@
+// Delta output (--delta): a query prints how its side differs from the
+// same side at the previous query, rather than the whole side.
+//
+// Each query's sorted view is kept, and the next view of that side is
+// merged against it in one linear pass. Entries present only in the new
+// view print as `+`, only in the old one as `-`. An old and a new entry
+// at the same price, met at the same point of the merge, print as one
+// `~` line carrying both quantities. The block has the usual header and
+// closing blank line and is printed whenever either view is non-empty,
+// so every query that would print a side in full still prints a block.
+// simulator/reconstruct.py turns a delta stream back into full output.
+
+#pragma once
+
+#include <stdio.h>
+
+#include "order_array.h"
+
+typedef struct {
+  OrderArray last; // the side at the previous query
+  OrderArray view; // the side at this query, as the book visits it
+} DeltaSide;
+
+void init_delta_side(DeltaSide *side);
+void free_delta_side(DeltaSide *side);
+
+// ObVisitor appending each order to side->view
+void collect_delta(const Order *order, void *ctx);
+
+// Print the difference between side->last and side->view to out under
+// header, then keep the view as the next query's last
+void print_delta(DeltaSide *side, OrderType type, const char *header,
+                 FILE *out);
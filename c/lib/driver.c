@@ -0,0 +1,490 @@
+#include "driver.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "arena.h"
+#include "async_io.h"
+#include "args.h"
+#include "compactor.h"
+#include "delta.h"
+#include "event_ring.h"
+#include "events.h"
+#include "latency.h"
+#include "line_cache.h"
+#include "parallel_format.h"
+#include "server.h"
+#include "stats.h"
+#include "timing.h"
+#include "work_pool.h"
+
+// ---------- Printing ----------
+
+typedef struct {
+  FILE *out;
+  const char *header; // printed before the first order only
+  bool started;
+  ParallelFormatter *formatter; // with --format-threads, NULL otherwise
+  size_t printed;
+} SidePrinter;
+
+// With --format-threads the orders past the formatter's threshold are
+// collected instead, and formatted in parallel once the side is done
+static void print_line(const Order *order, void *ctx) {
+  SidePrinter *printer = ctx;
+  if (!printer->started) {
+    engine_stats.bytes_written += fprintf(printer->out, "%s", printer->header);
+    printer->started = true;
+  }
+  if (printer->formatter &&
+      printer->printed == printer->formatter->threshold) {
+    collect_formatted(order, printer->formatter);
+    return;
+  }
+  engine_stats.bytes_written += fprintf(printer->out, "\t");
+  print_order(printer->out, order);
+  printer->printed++;
+}
+
+typedef struct {
+  Config cfg;
+  OrderBook *book;
+  FILE *out; // query output, NULL when silent
+  DeltaSide delta[2]; // indexed by OrderType, with --delta
+  LineCache *lines;   // with --line-cache, NULL otherwise
+  ParallelFormatter *formatter; // with --format-threads, NULL otherwise
+  Compactor compactor;          // with --compact
+  LatencyRecorder latency;
+} Driver;
+
+static void init_driver_output(Driver *d, FILE *out) {
+  d->out = out;
+  d->lines = NULL;
+  d->formatter = NULL;
+  if (!out)
+    return;
+  if (d->cfg.delta) {
+    init_delta_side(&d->delta[ORDER_BUY]);
+    init_delta_side(&d->delta[ORDER_SELL]);
+  } else if (d->cfg.line_cache) {
+    d->lines = malloc(sizeof *d->lines);
+    if (!d->lines) {
+      perror("malloc line cache");
+      exit(EXIT_FAILURE);
+    }
+    init_line_cache(d->lines, out);
+  } else if (d->cfg.format_threads > 1) {
+    d->formatter = malloc(sizeof *d->formatter);
+    if (!d->formatter) {
+      perror("malloc formatter");
+      exit(EXIT_FAILURE);
+    }
+    init_parallel_formatter(d->formatter, (unsigned)d->cfg.format_threads,
+                            (size_t)d->cfg.format_threshold);
+  }
+}
+
+static void free_driver_output(Driver *d) {
+  if (d->cfg.delta && d->out) {
+    free_delta_side(&d->delta[ORDER_BUY]);
+    free_delta_side(&d->delta[ORDER_SELL]);
+  }
+  if (d->lines) {
+    free_line_cache(d->lines);
+    free(d->lines);
+    d->lines = NULL;
+  }
+  if (d->formatter) {
+    free_parallel_formatter(d->formatter);
+    free(d->formatter);
+    d->formatter = NULL;
+  }
+}
+
+// An empty side prints nothing, not even its header. Nothing is printed
+// at all when silent. With --delta the side is printed as its changes
+// since the previous query, with --line-cache from cached lines, and
+// with --format-threads in parallel past the first threshold orders.
+static void handle_query(Driver *d, OrderType side) {
+  size_t (*query)(OrderBook *, ObVisitor, void *) =
+      side == ORDER_BUY ? ob_bids : ob_asks;
+  const char *header = side == ORDER_BUY ? "Bids\n" : "Asks\n";
+  if (!d->out) {
+    query(d->book, NULL, NULL);
+    return;
+  }
+  if (d->cfg.delta) {
+    query(d->book, collect_delta, &d->delta[side]);
+    print_delta(&d->delta[side], side, header, d->out);
+    return;
+  }
+  if (d->lines) {
+    // Nothing is flushed before the first order, so an empty side can
+    // take its header back
+    line_cache_append(d->lines, header, strlen(header));
+    if (query(d->book, line_cache_visit, d->lines) > 0)
+      line_cache_append(d->lines, "\n", 1);
+    else
+      d->lines->out_used -= strlen(header);
+    return;
+  }
+  SidePrinter printer = {d->out, header, false, d->formatter, 0};
+  if (query(d->book, print_line, &printer) == 0)
+    return;
+  if (d->formatter && d->formatter->orders.size > 0)
+    write_formatted(d->formatter, "\n", d->out);
+  else
+    engine_stats.bytes_written += fprintf(d->out, "\n");
+}
+
+static void print_stats(const Driver *d) {
+  print_engine_stats(stderr);
+  ob_print_stats(d->book, stderr);
+  if (d->lines)
+    print_line_cache_stats(d->lines, stderr);
+  if (d->formatter)
+    print_parallel_format_stats(d->formatter, stderr);
+  if (d->cfg.compact)
+    print_compactor_stats(&d->compactor, stderr);
+}
+
+// ---------- Main Loop ----------
+
+static void apply_to_book(const Event *event, void *ctx) {
+  Driver *d = ctx;
+  uint64_t start = 0;
+  if (d->cfg.latency)
+    start = now_ticks();
+
+  switch (event->type) {
+  case EVENT_CREATE: {
+    OrderType side =
+        event->data.create.side == SIDE_BUY ? ORDER_BUY : ORDER_SELL;
+    int order_id = ob_create(d->book, side, event->data.create.price,
+                             event->data.create.quantity);
+    if (d->lines)
+      line_cache_create(d->lines, order_id, side, event->data.create.price,
+                        event->data.create.quantity);
+    break;
+  }
+
+  case EVENT_UPDATE:
+    ob_update(d->book, event->data.update.order_id, event->data.update.price);
+    if (d->lines)
+      line_cache_update(d->lines, event->data.update.order_id,
+                        event->data.update.price);
+    break;
+
+  case EVENT_REMOVE:
+    ob_remove(d->book, event->data.remove.order_id);
+    if (d->lines)
+      line_cache_remove(d->lines, event->data.remove.order_id);
+    break;
+
+  case EVENT_BIDS:
+    handle_query(d, ORDER_BUY);
+    break;
+
+  case EVENT_ASKS:
+    handle_query(d, ORDER_SELL);
+    break;
+  }
+
+  if (d->cfg.latency)
+    record_latency(&d->latency, event->type, now_ticks() - start);
+}
+
+static void skip_order_id(void *ctx) { ob_skip_id(((Driver *)ctx)->book); }
+
+static void init_driver_book(Driver *d, const ObBackend *backend) {
+  d->book = ob_new(backend);
+  if (d->cfg.compact)
+    init_compactor(&d->compactor, apply_to_book, skip_order_id, d);
+}
+
+// Apply whatever the compactor still holds: at the end of the input,
+// and in server mode before a client's query reads the book
+static void finish_driver_book(void *ctx) {
+  Driver *d = ctx;
+  if (d->cfg.compact)
+    flush_compactor(&d->compactor);
+}
+
+static void free_driver_book(Driver *d) {
+  if (d->cfg.compact)
+    free_compactor(&d->compactor);
+  ob_free(d->book);
+}
+
+// Every input event comes through here; with --compact the order events
+// only reach the book, in their net form, at the next query
+static void apply_event(const Event *event, void *ctx) {
+  Driver *d = ctx;
+  if (d->cfg.compact)
+    compact_event(&d->compactor, event);
+  else
+    apply_to_book(event, d);
+
+  engine_stats.events++;
+  if (d->cfg.stats_every > 0 &&
+      engine_stats.events % (uint64_t)d->cfg.stats_every == 0)
+    print_stats(d);
+}
+
+// ---------- Lookahead ----------
+
+// With --prefetch W, events are read W ahead of the one being applied.
+// An UPDATE or REMOVE gets prefetch stage 0 when it is read and each later
+// stage a third of the window closer, so by the time it is applied its
+// id index slot and its order should already be in cache.
+
+static void prefetch_event(Driver *d, const Event *event, int stage) {
+  if (event->type == EVENT_UPDATE)
+    ob_prefetch(d->book, event->data.update.order_id, stage);
+  else if (event->type == EVENT_REMOVE)
+    ob_prefetch(d->book, event->data.remove.order_id, stage);
+}
+
+static void run_events(Driver *d, EventIterator *iter) {
+  Event event;
+  size_t window = (size_t)d->cfg.prefetch;
+  if (window == 0) {
+    while (event_iterator_next(iter, &event))
+      apply_event(&event, d);
+    return;
+  }
+  if (window < OB_PREFETCH_STAGES)
+    window = OB_PREFETCH_STAGES;
+  size_t step = window / OB_PREFETCH_STAGES;
+
+  Event *ahead = malloc(window * sizeof *ahead);
+  if (!ahead) {
+    perror("malloc lookahead");
+    exit(EXIT_FAILURE);
+  }
+  // ahead[(head + i) % window] is the i-th upcoming event, i < count
+  size_t head = 0, count = 0;
+  while (count < window && event_iterator_next(iter, &ahead[count]))
+    prefetch_event(d, &ahead[count++], 0);
+
+  while (count > 0) {
+    for (int stage = 1; stage < OB_PREFETCH_STAGES; stage++) {
+      size_t distance = window - (size_t)stage * step;
+      if (distance < count)
+        prefetch_event(d, &ahead[(head + distance) % window], stage);
+    }
+    apply_event(&ahead[head], d);
+    if (event_iterator_next(iter, &ahead[head]))
+      prefetch_event(d, &ahead[head], 0);
+    else
+      count--;
+    head = (head + 1) % window;
+  }
+  free(ahead);
+}
+
+// ---------- Batch Mode ----------
+
+// --batch runs every input named in a list file in this one process, on a
+// work-stealing pool of threads. Each file gets its own book (and so its
+// own OrderPool and containers) on the thread that replays it, and its
+// own output file.
+
+typedef struct {
+  char *input;
+  char *output; // NULL when silent
+  off_t size;
+} BatchJob;
+
+typedef struct {
+  const Config *cfg;
+  const ObBackend *backend;
+  BatchJob *jobs;
+  uint64_t events; // all files, updated atomically
+  unsigned failed;
+} Batch;
+
+static void run_batch_job(size_t index, unsigned worker, void *ctx) {
+  (void)worker;
+  Batch *batch = ctx;
+  BatchJob *job = &batch->jobs[index];
+
+  FILE *in = fopen(job->input, batch->cfg->binary ? "rb" : "r");
+  FILE *out = job->output ? fopen(job->output, "w") : NULL;
+  if (!in || (job->output && !out)) {
+    perror(!in ? job->input : job->output);
+    __atomic_fetch_add(&batch->failed, 1, __ATOMIC_RELAXED);
+    if (in)
+      fclose(in);
+    return;
+  }
+
+  Driver d = {.cfg = *batch->cfg};
+  d.cfg.latency = false; // the reports are for single runs
+  d.cfg.stats_every = 0;
+  init_driver_book(&d, batch->backend);
+  init_driver_output(&d, out);
+
+  EventIterator iter;
+  event_iterator_init(&iter, in);
+  event_iterator_set_binary(&iter, d.cfg.binary);
+  uint64_t before = engine_stats.events;
+  run_events(&d, &iter);
+  finish_driver_book(&d);
+  __atomic_fetch_add(&batch->events, engine_stats.events - before,
+                     __ATOMIC_RELAXED);
+
+  event_iterator_close(&iter);
+  free_driver_output(&d);
+  if (out)
+    fclose(out);
+  free_driver_book(&d);
+}
+
+// One input per line, optionally followed by its output file (the input
+// with .out appended otherwise). Blank lines and lines starting with #
+// are skipped.
+static size_t read_batch_list(const char *path, bool silent, BatchJob **out) {
+  FILE *list = fopen(path, "r");
+  if (!list) {
+    perror(path);
+    exit(EXIT_FAILURE);
+  }
+  size_t count = 0, capacity = 64;
+  BatchJob *jobs = malloc(capacity * sizeof *jobs);
+  char line[4096];
+  while (jobs && fgets(line, sizeof line, list)) {
+    char *input = strtok(line, " \t\r\n");
+    if (!input || input[0] == '#')
+      continue;
+    char *output = strtok(NULL, " \t\r\n");
+    if (count == capacity)
+      jobs = realloc(jobs, (capacity *= 2) * sizeof *jobs);
+    if (!jobs)
+      break;
+    BatchJob *job = &jobs[count++];
+    job->input = strdup(input);
+    job->output = NULL;
+    if (!silent) {
+      job->output = malloc(strlen(input) + 5);
+      if (output)
+        job->output = strcpy(realloc(job->output, strlen(output) + 1), output);
+      else if (job->output)
+        sprintf(job->output, "%s.out", input);
+    }
+    struct stat st;
+    job->size = stat(input, &st) == 0 ? st.st_size : 0;
+  }
+  if (!jobs) {
+    perror("malloc batch list");
+    exit(EXIT_FAILURE);
+  }
+  fclose(list);
+  *out = jobs;
+  return count;
+}
+
+static int cmp_job_size_desc(const void *a, const void *b) {
+  off_t x = ((const BatchJob *)a)->size, y = ((const BatchJob *)b)->size;
+  return (x < y) - (x > y);
+}
+
+static int run_batch(const Config *cfg, const ObBackend *backend) {
+  Batch batch = {.cfg = cfg, .backend = backend};
+  size_t count = read_batch_list(cfg->batch_file, cfg->silent, &batch.jobs);
+  // Biggest first, so the deques start out balanced and what is left to
+  // steal at the end is small
+  qsort(batch.jobs, count, sizeof *batch.jobs, cmp_job_size_desc);
+
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  unsigned threads = cfg->threads > 0   ? (unsigned)cfg->threads
+                     : cpus > 0         ? (unsigned)cpus
+                                        : 1;
+
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  run_work_pool(count, threads, run_batch_job, &batch);
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  double seconds = (double)(end.tv_sec - start.tv_sec) +
+                   (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+
+  fprintf(stderr,
+          "batch: %zu files (%u failed), %llu events in %.3f s on %u "
+          "threads: %.0f events/s\n",
+          count, batch.failed, (unsigned long long)batch.events, seconds,
+          threads, seconds > 0 ? (double)batch.events / seconds : 0.0);
+
+  for (size_t i = 0; i < count; i++) {
+    free(batch.jobs[i].input);
+    free(batch.jobs[i].output);
+  }
+  free(batch.jobs);
+  return batch.failed ? EXIT_FAILURE : 0;
+}
+
+int run_driver(int argc, char *argv[], const ObBackend *backend) {
+  Driver d;
+  parse_args(&d.cfg, argc, argv);
+  init_arena((size_t)d.cfg.expected_orders, d.cfg.huge_pages);
+  if (d.cfg.batch_file)
+    return run_batch(&d.cfg, backend);
+  if (d.cfg.input_file) {
+    freopen(d.cfg.input_file, "r", stdin);
+  }
+
+  init_driver_book(&d, backend);
+
+  if (d.cfg.latency) {
+    init_latency_recorder(&d.latency);
+    calibrate_ticks();
+  }
+
+  if (d.cfg.async_io && !d.cfg.silent)
+    async_output_begin();
+  init_driver_output(&d, d.cfg.silent ? NULL : stdout);
+
+  if (d.cfg.listen_path) {
+    serve_book(d.book, d.cfg.listen_path, apply_event, finish_driver_book,
+               &d);
+  } else {
+    EventIterator iter;
+    event_iterator_init(&iter, stdin);
+    event_iterator_set_binary(&iter, d.cfg.binary);
+    EventRing ring;
+    AsyncInput *input = NULL;
+    if (d.cfg.shm_name) {
+      event_ring_attach(&ring, d.cfg.shm_name, d.cfg.busy_poll);
+      event_iterator_set_ring(&iter, &ring);
+    } else if (d.cfg.async_io) {
+      input = async_input_open(fileno(stdin));
+      event_iterator_set_async(&iter, input);
+    }
+
+    run_events(&d, &iter);
+
+    if (input)
+      async_input_close(input);
+    event_iterator_close(&iter);
+    if (d.cfg.shm_name)
+      event_ring_close(&ring);
+  }
+  finish_driver_book(&d);
+  if (d.lines)
+    line_cache_flush(d.lines);
+  async_output_end();
+
+  if (d.cfg.latency)
+    print_latency_report(&d.latency, stderr);
+  if (d.cfg.stats)
+    print_stats(&d);
+
+  free_driver_output(&d);
+  free_driver_book(&d);
+
+  return 0;
+}
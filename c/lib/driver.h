@@ -0,0 +1,9 @@
+// The command-line driver shared by the engines: parse the arguments,
+// read events and apply them to an OrderBook, print the query results
+// and, on request, latency and stats reports.
+
+#pragma once
+
+#include "orderbook.h"
+
+int run_driver(int argc, char *argv[], const ObBackend *backend);
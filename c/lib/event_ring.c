@@ -0,0 +1,259 @@
+#include "event_ring.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <sched.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#define RING_MAGIC 0x52455645u // "EVER"
+#define MIN_CAPACITY 256
+// The consumer publishes its index every this many records, and when it
+// runs dry. Must divide MIN_CAPACITY.
+#define TAIL_BATCH 64
+// Polls of the other side's index before going to sleep. With only one
+// CPU the other side cannot make progress while we poll, so we sleep
+// straight away.
+#define SPIN_LIMIT 4096
+
+// Each side's index sits on its own cache line, together with the flags
+// the other side sets rarely, so the hot stores do not bounce a line
+// the other side also writes.
+struct EventRingShared {
+  _Atomic uint32_t magic; // set last, once the header is ready
+  uint32_t capacity;
+  alignas(64) _Atomic uint32_t head; // next record the producer writes
+  _Atomic uint32_t finished;
+  _Atomic uint32_t consumer_waiting;
+  _Atomic uint32_t consumer_wake; // futex word the consumer sleeps on
+  alignas(64) _Atomic uint32_t tail; // next record the consumer reads
+  _Atomic uint32_t producer_waiting;
+  _Atomic uint32_t producer_wake;
+  alignas(64) BinaryEvent records[];
+};
+
+// ---------- Waiting ----------
+
+static inline void cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  __asm__ __volatile__("yield");
+#endif
+}
+
+// Sleep while *word still holds `seen`. Sleepers re-check their condition
+// after every return, so spurious wakeups are harmless.
+static void wait_on(_Atomic uint32_t *word, uint32_t seen) {
+#if defined(__linux__)
+  syscall(SYS_futex, (uint32_t *)word, FUTEX_WAIT, seen, NULL, NULL, 0);
+#else
+  (void)word;
+  (void)seen;
+  sched_yield();
+#endif
+}
+
+// A waker bumps the word first, so a sleeper that read the old value and
+// has not gone to sleep yet returns straight away.
+static void wake(_Atomic uint32_t *word) {
+  atomic_fetch_add(word, 1);
+#if defined(__linux__)
+  syscall(SYS_futex, (uint32_t *)word, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+#endif
+}
+
+// ---------- Creating and Attaching ----------
+
+// POSIX wants shared memory names to start with a slash
+static void shm_path(char *path, size_t size, const char *name) {
+  snprintf(path, size, "%s%s", name[0] == '/' ? "" : "/", name);
+}
+
+static size_t ring_bytes(uint32_t capacity) {
+  return sizeof(EventRingShared) + (size_t)capacity * sizeof(BinaryEvent);
+}
+
+static unsigned spin_limit(void) {
+  return sysconf(_SC_NPROCESSORS_ONLN) > 1 ? SPIN_LIMIT : 0;
+}
+
+static void map_ring(EventRing *ring, int fd, size_t bytes) {
+  void *p = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (p == MAP_FAILED) {
+    perror("mmap event ring");
+    exit(EXIT_FAILURE);
+  }
+  close(fd);
+  ring->shared = p;
+  ring->records = ring->shared->records;
+  ring->map_size = bytes;
+}
+
+void event_ring_create(EventRing *ring, const char *name, size_t capacity) {
+  uint32_t cap = MIN_CAPACITY;
+  while (cap < capacity && cap < (1u << 30))
+    cap *= 2;
+
+  char path[NAME_MAX];
+  shm_path(path, sizeof path, name);
+  shm_unlink(path); // a ring left behind by an earlier run
+  int fd = shm_open(path, O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (fd < 0 || ftruncate(fd, (off_t)ring_bytes(cap)) != 0) {
+    perror("shm_open event ring");
+    exit(EXIT_FAILURE);
+  }
+  memset(ring, 0, sizeof *ring);
+  map_ring(ring, fd, ring_bytes(cap)); // zeroed by ftruncate
+  ring->mask = cap - 1;
+  ring->spin_limit = spin_limit();
+  ring->shared->capacity = cap;
+  atomic_store_explicit(&ring->shared->magic, RING_MAGIC,
+                        memory_order_release);
+}
+
+static void pause_briefly(void) {
+  nanosleep(&(struct timespec){.tv_nsec = 1000000}, NULL);
+}
+
+void event_ring_attach(EventRing *ring, const char *name, bool busy_poll) {
+  char path[NAME_MAX];
+  shm_path(path, sizeof path, name);
+
+  // Wait for the producer to create the ring and size it
+  int fd;
+  struct stat st;
+  for (;;) {
+    fd = shm_open(path, O_RDWR, 0);
+    if (fd < 0 && errno != ENOENT) {
+      perror("shm_open event ring");
+      exit(EXIT_FAILURE);
+    }
+    if (fd >= 0 && fstat(fd, &st) == 0 &&
+        (size_t)st.st_size > sizeof(EventRingShared))
+      break;
+    if (fd >= 0)
+      close(fd);
+    pause_briefly();
+  }
+  shm_unlink(path);
+
+  memset(ring, 0, sizeof *ring);
+  map_ring(ring, fd, (size_t)st.st_size);
+  while (atomic_load_explicit(&ring->shared->magic, memory_order_acquire) !=
+         RING_MAGIC)
+    pause_briefly();
+  if (ring_bytes(ring->shared->capacity) != ring->map_size) {
+    fprintf(stderr, "Malformed event ring %s\n", path);
+    exit(EXIT_FAILURE);
+  }
+  ring->mask = ring->shared->capacity - 1;
+  ring->spin_limit = spin_limit();
+  ring->busy_poll = busy_poll;
+}
+
+void event_ring_close(EventRing *ring) {
+  if (ring->shared)
+    munmap(ring->shared, ring->map_size);
+  memset(ring, 0, sizeof *ring);
+}
+
+// ---------- Producer ----------
+
+// The head store and the consumer_waiting load (and the consumer's
+// matching store and load) are sequentially consistent, so either the
+// consumer sees the new head before it sleeps or the producer sees that
+// it is about to sleep and wakes it.
+
+static void wait_for_space(EventRing *ring) {
+  EventRingShared *s = ring->shared;
+  for (unsigned spins = 0;; spins++) {
+    ring->tail = atomic_load_explicit(&s->tail, memory_order_acquire);
+    if (ring->head - ring->tail <= ring->mask)
+      return;
+    if (spins < ring->spin_limit) {
+      cpu_relax();
+      continue;
+    }
+    uint32_t seen = atomic_load(&s->producer_wake);
+    atomic_store(&s->producer_waiting, 1);
+    if (ring->head - atomic_load(&s->tail) > ring->mask)
+      wait_on(&s->producer_wake, seen);
+    atomic_store(&s->producer_waiting, 0);
+  }
+}
+
+void event_ring_push(EventRing *ring, const BinaryEvent *rec) {
+  if (ring->head - ring->tail > ring->mask)
+    wait_for_space(ring);
+  ring->records[ring->head & ring->mask] = *rec;
+  ring->head++;
+  atomic_store(&ring->shared->head, ring->head);
+  if (atomic_load(&ring->shared->consumer_waiting))
+    wake(&ring->shared->consumer_wake);
+}
+
+void event_ring_finish(EventRing *ring) {
+  atomic_store(&ring->shared->finished, 1);
+  if (atomic_load(&ring->shared->consumer_waiting))
+    wake(&ring->shared->consumer_wake);
+}
+
+// ---------- Consumer ----------
+
+// A producer waiting for space is only woken every half ring of records
+// read (or when the ring runs dry), so it refills the ring in large
+// batches rather than trading places with the consumer every TAIL_BATCH
+// records.
+static void publish_tail(EventRing *ring, bool wake_producer) {
+  atomic_store(&ring->shared->tail, ring->tail);
+  if (wake_producer && atomic_load(&ring->shared->producer_waiting))
+    wake(&ring->shared->producer_wake);
+}
+
+// Wait until there is a record to read; false if there never will be
+static bool wait_for_records(EventRing *ring) {
+  EventRingShared *s = ring->shared;
+  publish_tail(ring, true);
+  for (unsigned spins = 0;; spins++) {
+    // Read finished first: the final head was published before it
+    bool finished = atomic_load_explicit(&s->finished, memory_order_acquire);
+    ring->head = atomic_load_explicit(&s->head, memory_order_acquire);
+    if (ring->head != ring->tail)
+      return true;
+    if (finished)
+      return false;
+    if (ring->busy_poll || spins < ring->spin_limit) {
+      cpu_relax();
+      continue;
+    }
+    uint32_t seen = atomic_load(&s->consumer_wake);
+    atomic_store(&s->consumer_waiting, 1);
+    if (atomic_load(&s->head) == ring->tail && !atomic_load(&s->finished))
+      wait_on(&s->consumer_wake, seen);
+    atomic_store(&s->consumer_waiting, 0);
+  }
+}
+
+bool event_ring_pop(EventRing *ring, BinaryEvent *rec) {
+  if (ring->head == ring->tail && !wait_for_records(ring))
+    return false;
+  *rec = ring->records[ring->tail & ring->mask];
+  ring->tail++;
+  if (ring->tail % TAIL_BATCH == 0)
+    publish_tail(ring, (ring->tail & (ring->mask >> 1)) == 0);
+  return true;
+}
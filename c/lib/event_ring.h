@@ -0,0 +1,50 @@
+// Single-producer single-consumer ring of BinaryEvent records in POSIX
+// shared memory, for feeding an engine from another process without a
+// pipe in between.
+//
+// The producer creates the ring under a name and pushes records; the
+// consumer attaches by name (waiting for the producer if it has not
+// started yet) and pops them. Both sides keep their own index in process
+// memory and only publish it to the shared header, so a push or pop is a
+// copy and an atomic store. Only a side that finds the ring empty (or
+// full) and has spun for a while makes a system call: it sleeps on a
+// futex until the other side wakes it. With busy polling the consumer
+// never sleeps.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "events.h"
+
+typedef struct EventRingShared EventRingShared;
+
+typedef struct EventRing {
+  EventRingShared *shared;
+  BinaryEvent *records;
+  size_t map_size;
+  uint32_t mask; // capacity - 1
+  // The side's own index and its last view of the other side's; indices
+  // run freely and wrap at 2^32
+  uint32_t head;
+  uint32_t tail;
+  unsigned spin_limit; // polls before sleeping, none on a single CPU
+  bool busy_poll;
+} EventRing;
+
+// Producer side. The capacity, in records, is rounded up to a power of
+// two. A stale ring of the same name is replaced.
+void event_ring_create(EventRing *ring, const char *name, size_t capacity);
+void event_ring_push(EventRing *ring, const BinaryEvent *rec);
+// Tell the consumer no more records are coming
+void event_ring_finish(EventRing *ring);
+
+// Consumer side. Attaching removes the name, so the ring goes away with
+// the two processes.
+void event_ring_attach(EventRing *ring, const char *name, bool busy_poll);
+// False once the producer has finished and the ring is drained
+bool event_ring_pop(EventRing *ring, BinaryEvent *rec);
+
+void event_ring_close(EventRing *ring);
@@ -3,46 +3,45 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "async_io.h"
+#include "event_ring.h"
 #include "events.h"
 
-// Helper function
-static OrderSide parse_side(const char *side_str) {
+static bool parse_side(const char *side_str, OrderSide *side) {
   if (strcmp(side_str, "Buy") == 0)
-    return SIDE_BUY;
-  if (strcmp(side_str, "Sell") == 0)
-    return SIDE_SELL;
-  fprintf(stderr, "Invalid side: %s\n", side_str);
-  exit(EXIT_FAILURE);
+    *side = SIDE_BUY;
+  else if (strcmp(side_str, "Sell") == 0)
+    *side = SIDE_SELL;
+  else
+    return false;
+  return true;
 }
 
-static Event parse_event(const char *input) {
+const char *parse_event_line(const char *input, Event *event_out) {
   Event event;
   char type[16];
   char arg1[16], arg2[16], arg3[16];
   int count = sscanf(input, "%15s %15s %15s %15s", type, arg1, arg2, arg3);
+  if (count < 1)
+    return "Empty event";
 
   if (strcmp(type, "CREATE") == 0) {
-    if (count != 4) {
-      fprintf(stderr, "Invalid CREATE event: %s\n", input);
-      exit(EXIT_FAILURE);
-    }
+    if (count != 4)
+      return "Invalid CREATE event";
     event.type = EVENT_CREATE;
-    event.data.create.side = parse_side(arg1);
+    if (!parse_side(arg1, &event.data.create.side))
+      return "Invalid side";
     event.data.create.quantity = atoi(arg2);
     event.data.create.price = atoi(arg3);
   } else if (strcmp(type, "UPDATE") == 0) {
-    if (count != 3) {
-      fprintf(stderr, "Invalid UPDATE event: %s\n", input);
-      exit(EXIT_FAILURE);
-    }
+    if (count != 3)
+      return "Invalid UPDATE event";
     event.type = EVENT_UPDATE;
     event.data.update.order_id = atoi(arg1);
     event.data.update.price = atoi(arg2);
   } else if (strcmp(type, "REMOVE") == 0) {
-    if (count != 2) {
-      fprintf(stderr, "Invalid REMOVE event: %s\n", input);
-      exit(EXIT_FAILURE);
-    }
+    if (count != 2)
+      return "Invalid REMOVE event";
     event.type = EVENT_REMOVE;
     event.data.remove.order_id = atoi(arg1);
   } else if (strcmp(type, "BIDS") == 0) {
@@ -50,28 +49,149 @@ static Event parse_event(const char *input) {
   } else if (strcmp(type, "ASKS") == 0) {
     event.type = EVENT_ASKS;
   } else {
-    fprintf(stderr, "Unknown event type: %s\n", type);
-    exit(EXIT_FAILURE);
+    return "Unknown event type";
   }
 
-  return event;
+  *event_out = event;
+  return NULL;
 }
 
 bool event_iterator_init(EventIterator *it, FILE *file) {
   it->file = file;
+  it->binary = false;
+  it->ring = NULL;
+  it->input = NULL;
+  it->pos = it->end = NULL;
   if (!it->file)
     return false;
   return true;
 }
-bool event_iterator_next(EventIterator *it, Event *event_out) {
-  if (fgets(it->line, LINE_BUF_SIZE, it->file) == NULL) {
-    return false; // EOF or error
+void event_iterator_set_binary(EventIterator *it, bool binary) {
+  it->binary = binary;
+}
+
+void event_iterator_set_ring(EventIterator *it, EventRing *ring) {
+  it->ring = ring;
+}
+
+void event_iterator_set_async(EventIterator *it, AsyncInput *input) {
+  it->input = input;
+}
+
+static Event decode_checked(const BinaryEvent *rec) {
+  if (rec->type > EVENT_ASKS || rec->side > SIDE_SELL) {
+    fprintf(stderr, "Invalid binary event record\n");
+    exit(EXIT_FAILURE);
   }
+  return decode_binary_event(rec);
+}
+
+// ---------- Chunked Input ----------
 
-  // Remove newline if present
-  it->line[strcspn(it->line, "\n")] = '\0';
+static bool next_chunk(EventIterator *it) {
+  size_t n = async_input_next(it->input, &it->pos);
+  it->end = n ? it->pos + n : it->pos;
+  return n > 0;
+}
+
+// Copy the next n bytes of input to dst. False if the input ends first.
+static bool read_input(EventIterator *it, void *dst, size_t n) {
+  char *out = dst;
+  while (n > 0) {
+    if (it->pos == it->end && !next_chunk(it))
+      return false;
+    size_t take = (size_t)(it->end - it->pos);
+    if (take > n)
+      take = n;
+    memcpy(out, it->pos, take);
+    it->pos += take;
+    out += take;
+    n -= take;
+  }
+  return true;
+}
 
-  *event_out = parse_event(it->line);
+// The next line without its newline, or NULL at the end of the input.
+// Lines inside a chunk are parsed where they are; only lines that span
+// two chunks are copied.
+static char *read_input_line(EventIterator *it) {
+  if (it->pos == it->end && !next_chunk(it))
+    return NULL;
+  char *newline = memchr(it->pos, '\n', (size_t)(it->end - it->pos));
+  if (newline) {
+    char *line = it->pos;
+    *newline = '\0';
+    it->pos = newline + 1;
+    return line;
+  }
+
+  size_t len = 0;
+  for (;;) {
+    size_t take = newline ? (size_t)(newline - it->pos)
+                          : (size_t)(it->end - it->pos);
+    if (len + take >= LINE_BUF_SIZE) {
+      fprintf(stderr, "Event line too long\n");
+      exit(EXIT_FAILURE);
+    }
+    memcpy(it->line + len, it->pos, take);
+    len += take;
+    it->pos += take;
+    if (newline) {
+      it->pos++;
+      break;
+    }
+    if (!next_chunk(it))
+      break; // a last line without a newline
+    newline = memchr(it->pos, '\n', (size_t)(it->end - it->pos));
+  }
+  it->line[len] = '\0';
+  return it->line;
+}
+
+// ---------- Event Sources ----------
+
+static bool binary_event_next(EventIterator *it, Event *event_out) {
+  BinaryEvent rec;
+  bool ok = it->input ? read_input(it, &rec, sizeof rec)
+                      : fread(&rec, sizeof rec, 1, it->file) == 1;
+  if (!ok)
+    return false; // EOF, error or truncated record
+  *event_out = decode_checked(&rec);
+  return true;
+}
+
+static bool ring_event_next(EventIterator *it, Event *event_out) {
+  BinaryEvent rec;
+  if (!event_ring_pop(it->ring, &rec))
+    return false;
+  *event_out = decode_checked(&rec);
+  return true;
+}
+
+bool event_iterator_next(EventIterator *it, Event *event_out) {
+  if (it->ring)
+    return ring_event_next(it, event_out);
+  if (it->binary)
+    return binary_event_next(it, event_out);
+
+  char *line = it->line;
+  if (it->input) {
+    if (!(line = read_input_line(it)))
+      return false;
+  } else {
+    if (fgets(it->line, LINE_BUF_SIZE, it->file) == NULL) {
+      return false; // EOF or error
+    }
+
+    // Remove newline if present
+    it->line[strcspn(it->line, "\n")] = '\0';
+  }
+
+  const char *error = parse_event_line(line, event_out);
+  if (error) {
+    fprintf(stderr, "%s: %s\n", error, line);
+    exit(EXIT_FAILURE);
+  }
   return true;
 }
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 
 typedef enum {
@@ -38,13 +39,84 @@ typedef struct {
   } data;
 } Event;
 
+// Binary event format: a headerless stream of fixed-size records in host
+// byte order, as written by simulator/simulate --binary. It skips the
+// text parser entirely.
+typedef struct {
+  uint8_t type; // EventType
+  uint8_t side; // OrderSide, CREATE only
+  uint16_t reserved;
+  int32_t arg1; // CREATE: quantity, UPDATE/REMOVE: order id
+  int32_t arg2; // CREATE/UPDATE: price
+} BinaryEvent;
+
+static inline BinaryEvent encode_binary_event(const Event *event) {
+  BinaryEvent rec = {.type = (uint8_t)event->type};
+  switch (event->type) {
+  case EVENT_CREATE:
+    rec.side = (uint8_t)event->data.create.side;
+    rec.arg1 = event->data.create.quantity;
+    rec.arg2 = event->data.create.price;
+    break;
+  case EVENT_UPDATE:
+    rec.arg1 = event->data.update.order_id;
+    rec.arg2 = event->data.update.price;
+    break;
+  case EVENT_REMOVE:
+    rec.arg1 = event->data.remove.order_id;
+    break;
+  case EVENT_BIDS:
+  case EVENT_ASKS:
+    break;
+  }
+  return rec;
+}
+
+static inline Event decode_binary_event(const BinaryEvent *rec) {
+  Event event = {.type = (EventType)rec->type};
+  switch (event.type) {
+  case EVENT_CREATE:
+    event.data.create.side = (OrderSide)rec->side;
+    event.data.create.quantity = rec->arg1;
+    event.data.create.price = rec->arg2;
+    break;
+  case EVENT_UPDATE:
+    event.data.update.order_id = rec->arg1;
+    event.data.update.price = rec->arg2;
+    break;
+  case EVENT_REMOVE:
+    event.data.remove.order_id = rec->arg1;
+    break;
+  case EVENT_BIDS:
+  case EVENT_ASKS:
+    break;
+  }
+  return event;
+}
+
+// Parse one line of the text format (without its newline). Returns NULL
+// on success and a description of the problem otherwise.
+const char *parse_event_line(const char *line, Event *event_out);
+
 // FIXME: This is probably good enough for jazz...
 #define LINE_BUF_SIZE 256
+typedef struct EventRing EventRing;
+typedef struct AsyncInput AsyncInput;
 typedef struct {
   FILE *file;
+  bool binary;
+  EventRing *ring; // read from a shared-memory ring instead of the file
+  AsyncInput *input; // read the file's bytes through this instead of stdio
+  char *pos, *end;   // the unparsed part of the input's current chunk
   char line[LINE_BUF_SIZE];
 } EventIterator;
 
 bool event_iterator_init(EventIterator *it, FILE *file);
+// Switch the iterator to reading BinaryEvent records instead of text.
+void event_iterator_set_binary(EventIterator *it, bool binary);
+// Take BinaryEvent records from an attached EventRing instead of the file.
+void event_iterator_set_ring(EventIterator *it, EventRing *ring);
+// Read the input through an AsyncInput (see async_io.h) instead of stdio.
+void event_iterator_set_async(EventIterator *it, AsyncInput *input);
 bool event_iterator_next(EventIterator *it, Event *event_out);
 void event_iterator_close(EventIterator *it);
\ No newline at end of file
@@ -0,0 +1,354 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "id_index.h"
+#include "stats.h"
+#include "timing.h"
+
+// EMPTY is zero so that a new table is just zeroed memory
+#define CTRL_EMPTY ((uint8_t)0x00)
+#define CTRL_DELETED ((uint8_t)0x01)
+#define CTRL_FULL ((uint8_t)0x80) // set in the control byte of full slots
+#define MIN_CAPACITY ID_INDEX_GROUP
+
+// Old groups drained into the new table by each put or remove during a
+// rehash. Any value above zero finishes a doubling long before the new
+// table fills up.
+#define DRAIN_GROUPS 1
+
+// ---------- Hashing ----------
+
+static inline uint64_t hash_key(int key) {
+  uint64_t x = (uint32_t)key;
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdu;
+  x ^= x >> 33;
+  return x;
+}
+
+// The low seven bits go in the control byte, the rest select the group
+static inline uint8_t h2(uint64_t hash) {
+  return (uint8_t)(CTRL_FULL | (hash & 0x7f));
+}
+static inline size_t h1(uint64_t hash) { return (size_t)(hash >> 7); }
+
+static inline size_t max_load(size_t capacity) {
+  return capacity - capacity / 8;
+}
+
+// ---------- Group Matching ----------
+
+// Bit i of the result is set if control byte i of the group equals b
+static inline uint32_t group_match(const uint8_t *group, uint8_t b) {
+#if defined(__SSE2__)
+  __m128i ctrl = _mm_loadu_si128((const __m128i *)group);
+  return (uint32_t)_mm_movemask_epi8(
+      _mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)b)));
+#else
+  uint32_t mask = 0;
+  for (int i = 0; i < ID_INDEX_GROUP; i++)
+    mask |= (uint32_t)(group[i] == b) << i;
+  return mask;
+#endif
+}
+
+// Bit i is set if control byte i is EMPTY or DELETED (the top bit is
+// clear exactly for those)
+static inline uint32_t group_match_free(const uint8_t *group) {
+#if defined(__SSE2__)
+  __m128i ctrl = _mm_loadu_si128((const __m128i *)group);
+  return ~(uint32_t)_mm_movemask_epi8(ctrl) & 0xffff;
+#else
+  uint32_t mask = 0;
+  for (int i = 0; i < ID_INDEX_GROUP; i++)
+    mask |= (uint32_t)!(group[i] & CTRL_FULL) << i;
+  return mask;
+#endif
+}
+
+// ---------- Allocation ----------
+
+// Large tables are mapped directly rather than taken from malloc, which
+// may serve them from the heap and then has to clear and copy them up
+// front. Fresh pages come zeroed as they are first touched, so the cost
+// of a new table is spread over the rehash that fills it.
+#define MAP_TABLE_BYTES ((size_t)1 << 20)
+
+static void *allocate_table(size_t bytes) {
+  if (bytes < MAP_TABLE_BYTES)
+    return calloc(bytes, 1);
+  void *p = mmap(NULL, bytes, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  return p == MAP_FAILED ? NULL : p;
+}
+
+static void free_table(void *table, size_t bytes) {
+  if (bytes < MAP_TABLE_BYTES)
+    free(table);
+  else if (table)
+    munmap(table, bytes);
+}
+
+static void allocate_slots(IdIndex *index, size_t capacity) {
+  index->capacity = capacity;
+  index->ctrl = allocate_table(capacity);
+  index->slots = allocate_table(capacity * sizeof *index->slots);
+  if (!index->ctrl || !index->slots) {
+    perror("malloc id index");
+    exit(EXIT_FAILURE);
+  }
+  index->tombstones = 0;
+  index->growth_left = max_load(capacity);
+}
+
+void id_index_init(IdIndex *index, size_t expected_size) {
+  size_t capacity = MIN_CAPACITY;
+  while (max_load(capacity) < expected_size)
+    capacity *= 2;
+  memset(index, 0, sizeof *index);
+  allocate_slots(index, capacity);
+}
+
+static void free_slots(uint8_t *ctrl, IdIndexSlot *slots, size_t capacity) {
+  free_table(ctrl, capacity);
+  free_table(slots, capacity * sizeof *slots);
+}
+
+void id_index_free(IdIndex *index) {
+  free_slots(index->ctrl, index->slots, index->capacity);
+  free_slots(index->old_ctrl, index->old_slots, index->old_capacity);
+  memset(index, 0, sizeof *index);
+}
+
+// ---------- Probing ----------
+
+// Groups are visited in triangular order, which covers every group when
+// the number of groups is a power of two.
+static inline size_t first_group(size_t capacity, uint64_t hash) {
+  return h1(hash) & (capacity / ID_INDEX_GROUP - 1);
+}
+
+static inline size_t next_group(size_t capacity, size_t group, size_t step) {
+  return (group + step) & (capacity / ID_INDEX_GROUP - 1);
+}
+
+// Index of the slot holding key, or capacity if it is absent. Matches
+// below `live_from` are ignored; in the old table those slots have already
+// been drained, but their control bytes are left alone so that probe
+// sequences through them still reach the rest of the table.
+static size_t find_slot(const uint8_t *ctrl, const IdIndexSlot *slots,
+                        size_t capacity, size_t live_from, int key,
+                        uint64_t hash) {
+  size_t group = first_group(capacity, hash);
+  for (size_t step = 1;; step++) {
+    const uint8_t *g = ctrl + group * ID_INDEX_GROUP;
+    for (uint32_t m = group_match(g, h2(hash)); m; m &= m - 1) {
+      size_t slot = group * ID_INDEX_GROUP + __builtin_ctz(m);
+      if (slots[slot].key == key && slot >= live_from) {
+        count_probe(step);
+        return slot;
+      }
+    }
+    if (group_match(g, CTRL_EMPTY) || step * ID_INDEX_GROUP >= capacity) {
+      count_probe(step);
+      return capacity;
+    }
+    group = next_group(capacity, group, step);
+  }
+}
+
+// First EMPTY or DELETED slot on the probe sequence for hash
+static size_t find_free_slot(const IdIndex *index, uint64_t hash) {
+  size_t group = first_group(index->capacity, hash);
+  for (size_t step = 1;; step++) {
+    uint32_t m = group_match_free(index->ctrl + group * ID_INDEX_GROUP);
+    if (m)
+      return group * ID_INDEX_GROUP + __builtin_ctz(m);
+    group = next_group(index->capacity, group, step);
+  }
+}
+
+// ---------- Incremental Rehashing ----------
+
+// growth_left always counts the old table's live entries as if they had
+// already been moved, so the new table cannot fill up before the old one
+// is drained. An entry that lands on a DELETED slot, or is removed before
+// it is moved, gives its reservation back.
+
+static inline bool rehashing(const IdIndex *index) {
+  return index->old_capacity != 0;
+}
+
+// Move the old slots in [index->drained, end) into the new table
+static void drain(IdIndex *index, size_t end) {
+  for (size_t slot = index->drained; slot < end; slot++) {
+    if (!(index->old_ctrl[slot] & CTRL_FULL))
+      continue;
+    uint64_t hash = hash_key(index->old_slots[slot].key);
+    size_t dst = find_free_slot(index, hash);
+    if (index->ctrl[dst] == CTRL_DELETED) {
+      index->tombstones--;
+      index->growth_left++;
+    }
+    index->ctrl[dst] = h2(hash);
+    index->slots[dst] = index->old_slots[slot];
+  }
+  index->drained = end;
+
+  if (end == index->old_capacity) {
+    free_slots(index->old_ctrl, index->old_slots, index->old_capacity);
+    index->old_ctrl = NULL;
+    index->old_slots = NULL;
+    index->old_capacity = 0;
+  }
+}
+
+static void drain_step(IdIndex *index) {
+  if (!rehashing(index))
+    return;
+  uint64_t start = now_ticks();
+  size_t end = index->drained + DRAIN_GROUPS * ID_INDEX_GROUP;
+  drain(index, end < index->old_capacity ? end : index->old_capacity);
+  engine_stats.map_resize_ticks += now_ticks() - start;
+}
+
+// Switch to a fresh table of the given capacity and start draining the
+// current one into it. When the capacity is unchanged this purges the
+// DELETED slots.
+static void start_rehash(IdIndex *index, size_t capacity) {
+  uint64_t start = now_ticks();
+  // Only happens if the new table fills up before the old one is
+  // drained, which DRAIN_GROUPS rules out for doubling
+  if (rehashing(index))
+    drain(index, index->old_capacity);
+
+  index->old_ctrl = index->ctrl;
+  index->old_slots = index->slots;
+  index->old_capacity = index->capacity;
+  index->drained = 0;
+  allocate_slots(index, capacity);
+  index->growth_left -= index->size;
+
+  engine_stats.map_resizes++;
+  engine_stats.map_resize_ticks += now_ticks() - start;
+}
+
+// ---------- Core Operations ----------
+
+Order *id_index_get(const IdIndex *index, int key) {
+  uint64_t hash = hash_key(key);
+  size_t slot = find_slot(index->ctrl, index->slots, index->capacity, 0, key,
+                          hash);
+  if (slot < index->capacity)
+    return index->slots[slot].value;
+  if (rehashing(index)) {
+    slot = find_slot(index->old_ctrl, index->old_slots, index->old_capacity,
+                     index->drained, key, hash);
+    if (slot < index->old_capacity)
+      return index->old_slots[slot].value;
+  }
+  return NULL;
+}
+
+void id_index_put(IdIndex *index, int key, Order *value) {
+  drain_step(index);
+
+  uint64_t hash = hash_key(key);
+  size_t slot = find_slot(index->ctrl, index->slots, index->capacity, 0, key,
+                          hash);
+  if (slot < index->capacity) {
+    index->slots[slot].value = value;
+    return;
+  }
+  if (rehashing(index)) {
+    slot = find_slot(index->old_ctrl, index->old_slots, index->old_capacity,
+                     index->drained, key, hash);
+    if (slot < index->old_capacity) {
+      index->old_slots[slot].value = value;
+      return;
+    }
+  }
+
+  slot = find_free_slot(index, hash);
+  if (index->ctrl[slot] == CTRL_EMPTY && index->growth_left == 0) {
+    // Purge tombstones if they are what fills the table, otherwise grow
+    bool mostly_tombstones = index->size * 2 < max_load(index->capacity);
+    start_rehash(index,
+                 mostly_tombstones ? index->capacity : index->capacity * 2);
+    slot = find_free_slot(index, hash);
+  }
+
+  if (index->ctrl[slot] == CTRL_DELETED)
+    index->tombstones--;
+  else
+    index->growth_left--;
+  index->ctrl[slot] = h2(hash);
+  index->slots[slot] = (IdIndexSlot){key, value};
+  index->size++;
+}
+
+Order *id_index_remove(IdIndex *index, int key) {
+  drain_step(index);
+
+  uint64_t hash = hash_key(key);
+  size_t slot = find_slot(index->ctrl, index->slots, index->capacity, 0, key,
+                          hash);
+  if (slot < index->capacity) {
+    const uint8_t *group =
+        index->ctrl + slot / ID_INDEX_GROUP * ID_INDEX_GROUP;
+    if (group_match(group, CTRL_EMPTY)) {
+      index->ctrl[slot] = CTRL_EMPTY;
+      index->growth_left++;
+    } else {
+      index->ctrl[slot] = CTRL_DELETED;
+      index->tombstones++;
+    }
+    index->size--;
+    return index->slots[slot].value;
+  }
+
+  if (rehashing(index)) {
+    slot = find_slot(index->old_ctrl, index->old_slots, index->old_capacity,
+                     index->drained, key, hash);
+    if (slot < index->old_capacity) {
+      // The old table is never probed for free slots, so the entry only
+      // has to stop matching
+      index->old_ctrl[slot] = CTRL_DELETED;
+      index->growth_left++;
+      index->size--;
+      return index->old_slots[slot].value;
+    }
+  }
+  return NULL;
+}
+
+// ---------- Prefetching ----------
+
+void id_index_prefetch(const IdIndex *index, int key, int stage) {
+  uint64_t hash = hash_key(key);
+  size_t group = first_group(index->capacity, hash);
+  const uint8_t *ctrl = index->ctrl + group * ID_INDEX_GROUP;
+  if (stage == 0) {
+    __builtin_prefetch(ctrl);
+    return;
+  }
+  for (uint32_t m = group_match(ctrl, h2(hash)); m; m &= m - 1) {
+    const IdIndexSlot *slot =
+        &index->slots[group * ID_INDEX_GROUP + __builtin_ctz(m)];
+    if (stage == 1) {
+      __builtin_prefetch(slot);
+      return;
+    }
+    if (slot->key == key) {
+      __builtin_prefetch(slot->value, 1);
+      return;
+    }
+  }
+}
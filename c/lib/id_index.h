@@ -0,0 +1,66 @@
+// Swiss-table style hash index from order id to Order*.
+//
+// Slots are split into groups of ID_INDEX_GROUP. Next to its key and
+// value every slot has a one-byte control word: EMPTY, DELETED, or seven
+// bits of the key's hash when it is full. A lookup compares a whole group
+// of control bytes against those seven bits at once (with SSE2 where
+// available) and only touches keys whose control byte matches, so probes
+// stay short even at the 7/8 maximum load factor.
+//
+// A removed slot becomes EMPTY again whenever its group still has an
+// EMPTY slot, since no probe sequence can have continued past such a
+// group. Only the remaining DELETED slots need purging, which is done by
+// rehashing into a fresh table of the same capacity when they crowd out
+// insertions.
+//
+// Rehashing is incremental so that no single operation pays for moving
+// the whole table. The previous table is kept next to the new one and
+// every put or remove drains a few of its groups, in order, into the new
+// table. Lookups check the new table first and then the part of the old
+// table that has not been drained yet.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "order.h"
+
+#define ID_INDEX_GROUP 16
+
+typedef struct {
+  int key;
+  Order *value;
+} IdIndexSlot;
+
+typedef struct {
+  uint8_t *ctrl; // one control byte per slot
+  IdIndexSlot *slots;
+  size_t capacity; // slots; a power of two and a multiple of ID_INDEX_GROUP
+  size_t size;        // live entries, in both tables while rehashing
+  size_t tombstones;  // DELETED control bytes
+  size_t growth_left; // insertions into EMPTY slots before a rehash
+
+  // The table being drained while a rehash is in progress
+  uint8_t *old_ctrl;
+  IdIndexSlot *old_slots;
+  size_t old_capacity; // 0 when no rehash is in progress
+  size_t drained;      // old slots below this have been moved
+} IdIndex;
+
+void id_index_init(IdIndex *index, size_t expected_size);
+void id_index_free(IdIndex *index);
+Order *id_index_get(const IdIndex *index, int key);
+// Insert key, or overwrite its value if it is already present.
+void id_index_put(IdIndex *index, int key, Order *value);
+// Remove key and return its value, or return NULL if it is not present.
+Order *id_index_remove(IdIndex *index, int key);
+
+// Software prefetch for an upcoming lookup of key, in three stages issued
+// some events apart: stage 0 fetches the key's first control group, stage
+// 1 the slot in that group whose control byte matches, and stage 2 the
+// Order that slot points to. Each stage reads only what the previous one
+// fetched. Only the first group is looked at, which is where nearly all
+// keys live, and nothing is counted in the probe statistics.
+#define ID_INDEX_PREFETCH_STAGES 3
+void id_index_prefetch(const IdIndex *index, int key, int stage);
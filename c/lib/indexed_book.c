@@ -0,0 +1,100 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "arena.h"
+#include "indexed_book.h"
+
+#define INITIAL_CAPACITY 4
+
+// ---------- Initialization and Cleanup ----------
+
+static void init_book_side(BookSide *side) {
+  side->size = 0;
+  side->capacity = capacity_hint(INITIAL_CAPACITY);
+  side->data = arena_alloc(side->capacity * sizeof *side->data);
+}
+
+static void free_book_side(BookSide *side) {
+  arena_free(side->data);
+  side->data = NULL;
+  side->size = side->capacity = 0;
+}
+
+void init_indexed_book(IndexedBook *book) {
+  init_book_side(&book->buys);
+  init_book_side(&book->sells);
+  id_index_init(&book->index, capacity_hint(2 * INITIAL_CAPACITY));
+  book->slots_capacity = capacity_hint(2 * INITIAL_CAPACITY);
+  book->slots = arena_alloc(book->slots_capacity * sizeof *book->slots);
+}
+
+void free_indexed_book(IndexedBook *book) {
+  free_book_side(&book->buys);
+  free_book_side(&book->sells);
+  id_index_free(&book->index);
+  arena_free(book->slots);
+  book->slots = NULL;
+  book->slots_capacity = 0;
+}
+
+// ---------- Core Operations ----------
+
+static inline BookSide *side_of(IndexedBook *book, const Order *order) {
+  return order->order_type == ORDER_BUY ? &book->buys : &book->sells;
+}
+
+void add_book_order(IndexedBook *book, Order *order) {
+  BookSide *side = side_of(book, order);
+  if (side->size == side->capacity) {
+    side->capacity *= 2;
+    side->data = arena_grow(side->data, side->size * sizeof *side->data,
+                            side->capacity * sizeof *side->data);
+  }
+  if ((size_t)order->order_id >= book->slots_capacity) {
+    size_t used = book->slots_capacity * sizeof *book->slots;
+    while ((size_t)order->order_id >= book->slots_capacity)
+      book->slots_capacity *= 2;
+    book->slots = arena_grow(book->slots, used,
+                             book->slots_capacity * sizeof *book->slots);
+  }
+  book->slots[order->order_id] = (unsigned)side->size;
+  side->data[side->size++] = order;
+  id_index_put(&book->index, order->order_id, order);
+}
+
+Order *find_book_order(const IndexedBook *book, int order_id) {
+  return id_index_get(&book->index, order_id);
+}
+
+Order *remove_book_order(IndexedBook *book, int order_id) {
+  Order *order = id_index_remove(&book->index, order_id);
+  if (!order)
+    return NULL;
+
+  BookSide *side = side_of(book, order);
+  unsigned slot = book->slots[order_id];
+  Order *last = side->data[--side->size];
+  side->data[slot] = last;
+  book->slots[last->order_id] = slot;
+  return order;
+}
+
+// ---------- Sorting ----------
+
+void sort_book_side(IndexedBook *book, BookSide *side, BookSideSort sort) {
+  sort(&side->data, side->data + side->size);
+  for (size_t i = 0; i < side->size; i++)
+    book->slots[side->data[i]->order_id] = (unsigned)i;
+}
+
+// ---------- Statistics ----------
+
+void print_book_stats(const IndexedBook *book, FILE *out) {
+  const IdIndex *index = &book->index;
+  fprintf(out,
+          "id index:      %zu buys, %zu sells, %zu slots, load %.3f, "
+          "tombstones %.3f\n",
+          book->buys.size, book->sells.size, index->capacity,
+          (double)index->size / (double)index->capacity,
+          (double)index->tombstones / (double)index->capacity);
+}
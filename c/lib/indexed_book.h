@@ -0,0 +1,46 @@
+// Both sides of an order book behind a single id index.
+//
+// The sides are unsorted arrays of Order* and one IdIndex maps an order
+// id to its Order for either side. The order records its side
+// (order_type), and an array indexed by order id (ids are dense) holds
+// its slot in that side's array, so UPDATE and REMOVE cost exactly one
+// hash lookup, and an unknown id is rejected after a single probe
+// sequence. REMOVE fills the hole with the side's last order.
+//
+// Sorting a side moves orders between slots, so sides are only sorted
+// through sort_book_side, which renumbers them afterwards.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "id_index.h"
+#include "order.h"
+
+typedef struct {
+  Order **data;
+  size_t size;
+  size_t capacity;
+} BookSide;
+
+typedef struct {
+  BookSide buys;
+  BookSide sells;
+  IdIndex index; // order_id → Order*, shared by both sides
+  unsigned *slots; // order_id → position in its side, for live orders
+  size_t slots_capacity;
+} IndexedBook;
+
+// Sorts the orders in [*begin, end) in place, as the radix sorts do
+typedef void (*BookSideSort)(Order ***begin, Order **end);
+
+void init_indexed_book(IndexedBook *book);
+void free_indexed_book(IndexedBook *book);
+void add_book_order(IndexedBook *book, Order *order);
+Order *find_book_order(const IndexedBook *book, int order_id);
+// Unlink the order from its side and the index and return it, or return
+// NULL if the id is unknown.
+Order *remove_book_order(IndexedBook *book, int order_id);
+void sort_book_side(IndexedBook *book, BookSide *side, BookSideSort sort);
+void print_book_stats(const IndexedBook *book, FILE *out);
@@ -0,0 +1,57 @@
+#include <string.h>
+
+#include "latency.h"
+#include "timing.h"
+
+static const char *event_names[LATENCY_EVENT_TYPES] = {
+    [EVENT_CREATE] = "CREATE", [EVENT_UPDATE] = "UPDATE",
+    [EVENT_REMOVE] = "REMOVE", [EVENT_BIDS] = "BIDS",
+    [EVENT_ASKS] = "ASKS",
+};
+
+void init_latency_recorder(LatencyRecorder *rec) {
+  memset(rec, 0, sizeof *rec);
+}
+
+// Largest value that lands in the same bucket as idx
+static uint64_t bucket_upper_bound(size_t idx) {
+  if (idx < LATENCY_SUB_BUCKETS)
+    return idx;
+  int shift = (int)(idx / LATENCY_HALF_BUCKETS) - 1;
+  uint64_t sub = idx % LATENCY_HALF_BUCKETS + LATENCY_HALF_BUCKETS;
+  return (sub << shift) + ((uint64_t)1 << shift) - 1;
+}
+
+uint64_t latency_percentile(const LatencyHistogram *h, double p) {
+  if (h->total == 0)
+    return 0;
+  double exact = p * (double)h->total;
+  uint64_t rank = (uint64_t)exact;
+  if (rank < exact || rank == 0)
+    rank++;
+  uint64_t seen = 0;
+  for (size_t i = 0; i < LATENCY_BUCKETS; i++) {
+    seen += h->counts[i];
+    if (seen >= rank) {
+      uint64_t v = bucket_upper_bound(i);
+      return v < h->max ? v : h->max;
+    }
+  }
+  return h->max;
+}
+
+void print_latency_report(const LatencyRecorder *rec, FILE *out) {
+  fprintf(out, "%-8s %12s %10s %10s %10s %12s\n", "event", "count",
+          "p50 (ns)", "p99 (ns)", "p99.9 (ns)", "max (ns)");
+  for (int t = 0; t < LATENCY_EVENT_TYPES; t++) {
+    const LatencyHistogram *h = &rec->events[t];
+    if (h->total == 0)
+      continue;
+    fprintf(out, "%-8s %12llu %10.0f %10.0f %10.0f %12.0f\n", event_names[t],
+            (unsigned long long)h->total,
+            ticks_to_ns(latency_percentile(h, 0.50)),
+            ticks_to_ns(latency_percentile(h, 0.99)),
+            ticks_to_ns(latency_percentile(h, 0.999)),
+            ticks_to_ns(h->max));
+  }
+}
@@ -0,0 +1,52 @@
+// Per-event-type latency histograms.
+//
+// The histograms are log-linear in the style of HdrHistogram: values are
+// grouped by their highest set bit and each group is split into
+// LATENCY_SUB_BUCKETS linear buckets, so every recorded value is kept to
+// within ~6% relative precision. All storage is inline, so recording a
+// sample is an index computation and an increment.
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "events.h"
+
+#define LATENCY_SUB_BITS 5
+#define LATENCY_SUB_BUCKETS (1 << LATENCY_SUB_BITS)
+#define LATENCY_HALF_BUCKETS (LATENCY_SUB_BUCKETS / 2)
+#define LATENCY_BUCKETS ((64 - LATENCY_SUB_BITS + 2) * LATENCY_HALF_BUCKETS)
+#define LATENCY_EVENT_TYPES (EVENT_ASKS + 1)
+
+typedef struct {
+  uint64_t counts[LATENCY_BUCKETS];
+  uint64_t total;
+  uint64_t max;
+} LatencyHistogram;
+
+typedef struct {
+  LatencyHistogram events[LATENCY_EVENT_TYPES]; // indexed by EventType
+} LatencyRecorder;
+
+static inline size_t latency_bucket(uint64_t value) {
+  if (value < LATENCY_SUB_BUCKETS)
+    return value;
+  int shift = 63 - __builtin_clzll(value) - (LATENCY_SUB_BITS - 1);
+  return (size_t)shift * LATENCY_HALF_BUCKETS + (value >> shift);
+}
+
+static inline void record_latency(LatencyRecorder *rec, EventType type,
+                                  uint64_t ticks) {
+  LatencyHistogram *h = &rec->events[type];
+  h->counts[latency_bucket(ticks)]++;
+  h->total++;
+  if (ticks > h->max)
+    h->max = ticks;
+}
+
+void init_latency_recorder(LatencyRecorder *rec);
+// Smallest recorded value v such that a fraction p of samples are <= v,
+// in ticks and rounded up to the end of its bucket.
+uint64_t latency_percentile(const LatencyHistogram *h, double p);
+void print_latency_report(const LatencyRecorder *rec, FILE *out);
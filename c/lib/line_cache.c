@@ -0,0 +1,167 @@
+#include "line_cache.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+#include "stats.h"
+
+#define LINE_CACHE_NONE UINT32_MAX
+#define OUT_BUFFER_SIZE (64 * 1024)
+#define LINE_MAX_BYTES 64 // "\tSell", two ints, spaces and newline fit
+
+// ---------- Initialization and Cleanup ----------
+
+void init_line_cache(LineCache *cache, FILE *stream) {
+  cache->stream = stream;
+  cache->ids = capacity_hint(1024);
+  cache->entry_of = arena_alloc(cache->ids * sizeof *cache->entry_of);
+  cache->capacity = capacity_hint(1024);
+  cache->lines = arena_alloc(cache->capacity * sizeof *cache->lines);
+  cache->out = malloc(OUT_BUFFER_SIZE);
+  if (!cache->entry_of || !cache->lines || !cache->out) {
+    perror("malloc line cache");
+    exit(EXIT_FAILURE);
+  }
+  memset(cache->entry_of, 0xff, cache->ids * sizeof *cache->entry_of);
+  cache->size = 0;
+  cache->free_list = LINE_CACHE_NONE;
+  cache->out_used = 0;
+  cache->live = 0;
+  cache->hits = cache->misses = 0;
+}
+
+void free_line_cache(LineCache *cache) {
+  line_cache_flush(cache);
+  arena_free(cache->entry_of);
+  arena_free(cache->lines);
+  free(cache->out);
+}
+
+// ---------- Lines ----------
+
+static void render(CachedLine *line, int price) {
+  char buf[64];
+  int n = snprintf(buf, sizeof buf, "\t%s %d %d\n",
+                   line->order_type == ORDER_BUY ? "Buy" : "Sell", price,
+                   line->quantity);
+  if (n > 0 && n <= LINE_CACHE_TEXT) {
+    memcpy(line->text, buf, (size_t)n);
+    line->length = (uint8_t)n;
+  } else {
+    line->length = 0;
+  }
+}
+
+static inline CachedLine *live_line(const LineCache *cache, int order_id) {
+  if (order_id < 0 || (size_t)order_id >= cache->ids ||
+      cache->entry_of[order_id] == LINE_CACHE_NONE)
+    return NULL;
+  return &cache->lines[cache->entry_of[order_id]];
+}
+
+static uint32_t new_entry(LineCache *cache) {
+  if (cache->free_list != LINE_CACHE_NONE) {
+    uint32_t entry = cache->free_list;
+    cache->free_list = (uint32_t)cache->lines[entry].quantity;
+    return entry;
+  }
+  if (cache->size == cache->capacity) {
+    cache->lines = arena_grow(cache->lines,
+                              cache->capacity * sizeof *cache->lines,
+                              2 * cache->capacity * sizeof *cache->lines);
+    cache->capacity *= 2;
+  }
+  return (uint32_t)cache->size++;
+}
+
+void line_cache_create(LineCache *cache, int order_id, OrderType type,
+                       int price, int quantity) {
+  if (order_id < 0)
+    return;
+  if ((size_t)order_id >= cache->ids) {
+    size_t ids = cache->ids;
+    while (ids <= (size_t)order_id)
+      ids *= 2;
+    cache->entry_of =
+        arena_grow(cache->entry_of, cache->ids * sizeof *cache->entry_of,
+                   ids * sizeof *cache->entry_of);
+    memset(cache->entry_of + cache->ids, 0xff,
+           (ids - cache->ids) * sizeof *cache->entry_of);
+    cache->ids = ids;
+  }
+  uint32_t entry = new_entry(cache);
+  CachedLine *line = &cache->lines[entry];
+  line->quantity = quantity;
+  line->order_type = (uint8_t)type;
+  render(line, price);
+  cache->entry_of[order_id] = entry;
+  cache->live++;
+}
+
+void line_cache_update(LineCache *cache, int order_id, int price) {
+  CachedLine *line = live_line(cache, order_id);
+  if (line)
+    render(line, price);
+}
+
+void line_cache_remove(LineCache *cache, int order_id) {
+  if (!live_line(cache, order_id))
+    return;
+  uint32_t entry = cache->entry_of[order_id];
+  cache->lines[entry].quantity = (int)cache->free_list;
+  cache->free_list = entry;
+  cache->entry_of[order_id] = LINE_CACHE_NONE;
+  cache->live--;
+}
+
+// ---------- Queries ----------
+
+void line_cache_flush(LineCache *cache) {
+  if (cache->out_used > 0) {
+    fwrite(cache->out, 1, cache->out_used, cache->stream);
+    engine_stats.bytes_written += cache->out_used;
+    cache->out_used = 0;
+  }
+}
+
+// Make room for one more line of up to LINE_MAX_BYTES
+static inline char *reserve(LineCache *cache) {
+  if (cache->out_used + LINE_MAX_BYTES > OUT_BUFFER_SIZE)
+    line_cache_flush(cache);
+  return cache->out + cache->out_used;
+}
+
+void line_cache_append(LineCache *cache, const char *text, size_t length) {
+  memcpy(reserve(cache), text, length);
+  cache->out_used += length;
+}
+
+void line_cache_visit(const Order *order, void *ctx) {
+  LineCache *cache = ctx;
+  char *dst = reserve(cache);
+  const CachedLine *line = live_line(cache, order->order_id);
+  if (line && line->length > 0) {
+    memcpy(dst, line->text, line->length);
+    cache->out_used += line->length;
+    cache->hits++;
+  } else {
+    dst[0] = '\t';
+    cache->out_used +=
+        1 + (size_t)format_order(dst + 1, LINE_MAX_BYTES - 1, order);
+    cache->misses++;
+  }
+}
+
+// ---------- Statistics ----------
+
+void print_line_cache_stats(const LineCache *cache, FILE *out) {
+  fprintf(out,
+          "line cache: %zu live lines in %zu entries (%zu KiB), "
+          "%llu copied, %llu formatted\n",
+          cache->live, cache->size,
+          (cache->capacity * sizeof *cache->lines +
+           cache->ids * sizeof *cache->entry_of) /
+              1024,
+          (unsigned long long)cache->hits, (unsigned long long)cache->misses);
+}
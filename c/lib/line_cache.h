@@ -0,0 +1,65 @@
+// Preformatted query output lines, one per live order (--line-cache).
+//
+// An order's output line only changes when its price does, so the driver
+// renders it once on CREATE, again on UPDATE, and drops it on REMOVE. A
+// query then copies the cached lines into an output buffer instead of
+// formatting every order from its integers.
+//
+// Lines live in fixed 32-byte entries in one growable array, with freed
+// entries reused before the array grows, and an array indexed by order
+// id (ids are dense) points at each order's entry. A line that does not
+// fit an entry (only possible for extreme prices and quantities) is not
+// cached, and the query formats that order as usual.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "order.h"
+
+#define LINE_CACHE_TEXT 26
+
+typedef struct {
+  int quantity;
+  uint8_t order_type; // OrderType
+  uint8_t length;     // of text; 0 when the line did not fit
+  char text[LINE_CACHE_TEXT]; // "\tSide Price Quantity\n", no terminator
+} CachedLine;
+
+typedef struct {
+  uint32_t *entry_of; // by order id; LINE_CACHE_NONE when not live
+  size_t ids;         // length of entry_of
+  CachedLine *lines;
+  size_t size, capacity; // entries handed out, entries allocated
+  uint32_t free_list;    // freed entries, linked through their quantity
+
+  FILE *stream;       // where the query output goes
+  char *out;          // query output buffer
+  size_t out_used;
+
+  // Statistics
+  size_t live;
+  uint64_t hits, misses; // lines copied, and formatted at query time
+} LineCache;
+
+// Query output goes to stream, through the cache's buffer
+void init_line_cache(LineCache *cache, FILE *stream);
+// Flushes the buffer first
+void free_line_cache(LineCache *cache);
+
+void line_cache_create(LineCache *cache, int order_id, OrderType type,
+                       int price, int quantity);
+// Unknown and removed ids are ignored, like the book ignores them
+void line_cache_update(LineCache *cache, int order_id, int price);
+void line_cache_remove(LineCache *cache, int order_id);
+
+// ObVisitor appending the order's line to the output buffer
+void line_cache_visit(const Order *order, void *ctx);
+// Append other text (headers, blank lines) of at most 64 bytes
+void line_cache_append(LineCache *cache, const char *text, size_t length);
+// Write out whatever the buffer holds
+void line_cache_flush(LineCache *cache);
+
+void print_line_cache_stats(const LineCache *cache, FILE *out);
@@ -0,0 +1,237 @@
+// The sorted-list engine. Each side is an array kept sorted at all
+// times, so queries never sort. The best price is at the end of the
+// array, where most of the activity is, and queries visit the array
+// backwards. An order is placed with a binary search for its position
+// and a single memmove of the orders in between.
+//
+// Order ids are small and mostly dense, so the id index is a plain
+// array, grown to whatever id arrives (--compact skips the ids of
+// cancelled creates). It holds each order's side and sort key, or
+// SIDE_NONE, rather than its position, which a memmove would change for
+// every order it shifts; the position is found again by binary search
+// on the key.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+#include "order.h"
+#include "order_array.h"
+#include "orderbook.h"
+
+static int cmp_order_asc(const Order *o1, const Order *o2) {
+  if (o1->price != o2->price)
+    return o1->price - o2->price;
+  return o1->quantity - o2->quantity;
+}
+
+static int cmp_order_desc(const Order *o1, const Order *o2) {
+  if (o1->price != o2->price)
+    return o2->price - o1->price;
+  return o2->quantity - o1->quantity;
+}
+
+typedef struct {
+  OrderArray orders;
+  int (*cmp)(const Order *, const Order *);
+} SortedOrders;
+
+#define SIDE_NONE (-1)
+
+typedef struct {
+  int side; // OrderType, or SIDE_NONE once removed
+  int price;
+  int quantity;
+} OrderKey;
+
+typedef struct {
+  SortedOrders sides[2]; // indexed by OrderType
+  OrderKey *keys;        // indexed by order id
+  size_t keys_capacity;
+} SortedBook;
+
+// ---------- Initialization and Cleanup ----------
+
+static void clear_keys(OrderKey *keys, size_t from, size_t to) {
+  for (size_t i = from; i < to; i++)
+    keys[i].side = SIDE_NONE;
+}
+
+static void *init_sorted(void) {
+  SortedBook *book = malloc(sizeof *book);
+  if (!book) {
+    perror("malloc sorted book");
+    exit(1);
+  }
+  init_order_array(&book->sides[ORDER_BUY].orders);
+  book->sides[ORDER_BUY].cmp = cmp_order_asc;
+  init_order_array(&book->sides[ORDER_SELL].orders);
+  book->sides[ORDER_SELL].cmp = cmp_order_desc;
+  book->keys_capacity = capacity_hint(1024);
+  book->keys = arena_alloc(book->keys_capacity * sizeof *book->keys);
+  clear_keys(book->keys, 0, book->keys_capacity);
+  return book;
+}
+
+static void free_sorted(void *impl) {
+  SortedBook *book = impl;
+  free_order_array(&book->sides[ORDER_BUY].orders);
+  free_order_array(&book->sides[ORDER_SELL].orders);
+  arena_free(book->keys);
+  free(book);
+}
+
+// ---------- Positioning ----------
+
+// First position in [lo, hi) whose order sorts after o
+static size_t upper_bound(const SortedOrders *side, size_t lo, size_t hi,
+                          const Order *o) {
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (side->cmp(&side->orders.data[mid], o) > 0)
+      hi = mid;
+    else
+      lo = mid + 1;
+  }
+  return lo;
+}
+
+// First position in [lo, hi) whose order does not sort before o
+static size_t lower_bound(const SortedOrders *side, size_t lo, size_t hi,
+                          const Order *o) {
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (side->cmp(&side->orders.data[mid], o) < 0)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+// Position of a live order: the first with its key, then a scan over
+// the (rare) other orders with the same price and quantity
+static size_t find_position(const SortedOrders *side, int order_id,
+                            const OrderKey *key) {
+  Order o = make_order(order_id, (OrderType)key->side, key->price,
+                       key->quantity);
+  size_t i = lower_bound(side, 0, side->orders.size, &o);
+  while (side->orders.data[i].order_id != order_id)
+    i++;
+  return i;
+}
+
+// Move the order at position `from` to position `to`, shifting the
+// orders in between by one
+static void move_order(SortedOrders *side, size_t from, size_t to) {
+  Order *data = side->orders.data;
+  Order order = data[from];
+  if (to < from)
+    memmove(&data[to + 1], &data[to], (from - to) * sizeof *data);
+  else if (to > from)
+    memmove(&data[from], &data[from + 1], (to - from) * sizeof *data);
+  data[to] = order;
+}
+
+static void insert_sorted(SortedOrders *side, Order order) {
+  size_t at = upper_bound(side, 0, side->orders.size, &order);
+  append_order(&side->orders, order);
+  move_order(side, side->orders.size - 1, at);
+}
+
+// Restore the order at `index` after its price changed. It moves past
+// the orders it now strictly sorts before or after and nothing else.
+static void reposition(SortedOrders *side, size_t index) {
+  const Order *data = side->orders.data;
+  const Order *order = &data[index];
+  if (index > 0 && side->cmp(order, &data[index - 1]) < 0) {
+    move_order(side, index, upper_bound(side, 0, index, order));
+  } else if (index + 1 < side->orders.size &&
+             side->cmp(order, &data[index + 1]) > 0) {
+    size_t end = lower_bound(side, index + 1, side->orders.size, order);
+    move_order(side, index, end - 1);
+  }
+}
+
+static void remove_at(SortedOrders *side, size_t index) {
+  OrderArray *orders = &side->orders;
+  orders->size--;
+  memmove(&orders->data[index], &orders->data[index + 1],
+          (orders->size - index) * sizeof *orders->data);
+}
+
+// ---------- Orders ----------
+
+static void create_sorted(void *impl, Order order) {
+  SortedBook *book = impl;
+  if ((size_t)order.order_id >= book->keys_capacity) {
+    size_t capacity = book->keys_capacity;
+    while ((size_t)order.order_id >= capacity)
+      capacity *= 2;
+    size_t used = book->keys_capacity * sizeof *book->keys;
+    book->keys = arena_grow(book->keys, used, capacity * sizeof *book->keys);
+    clear_keys(book->keys, book->keys_capacity, capacity);
+    book->keys_capacity = capacity;
+  }
+  book->keys[order.order_id] =
+      (OrderKey){order.order_type, order.price, order.quantity};
+  insert_sorted(&book->sides[order.order_type], order);
+}
+
+static void update_sorted(void *impl, int order_id, int price) {
+  SortedBook *book = impl;
+  if ((size_t)order_id >= book->keys_capacity)
+    return;
+  OrderKey *key = &book->keys[order_id];
+  if (key->side == SIDE_NONE)
+    return;
+  SortedOrders *side = &book->sides[key->side];
+  size_t index = find_position(side, order_id, key);
+  side->orders.data[index].price = key->price = price;
+  reposition(side, index);
+}
+
+static void remove_sorted(void *impl, int order_id) {
+  SortedBook *book = impl;
+  if ((size_t)order_id >= book->keys_capacity)
+    return;
+  OrderKey *key = &book->keys[order_id];
+  if (key->side == SIDE_NONE)
+    return;
+  SortedOrders *side = &book->sides[key->side];
+  remove_at(side, find_position(side, order_id, key));
+  key->side = SIDE_NONE;
+}
+
+// ---------- Queries ----------
+
+// Best price first, which is last in the array
+static size_t query_sorted(void *impl, OrderType type, ObVisitor visit,
+                           void *ctx) {
+  const OrderArray *orders = &((SortedBook *)impl)->sides[type].orders;
+  if (visit)
+    for (size_t i = orders->size; i-- > 0;)
+      visit(&orders->data[i], ctx);
+  return orders->size;
+}
+
+static void print_sorted_stats(const void *impl, FILE *out) {
+  const SortedBook *book = impl;
+  fprintf(out, "sorted sides:  %zu buys, %zu sells, %zu id keys\n",
+          book->sides[ORDER_BUY].orders.size,
+          book->sides[ORDER_SELL].orders.size, book->keys_capacity);
+}
+
+// ---------- Backend ----------
+
+const ObBackend ob_sorted_backend = {
+    .name = "sorted",
+    .init_book = init_sorted,
+    .free_book = free_sorted,
+    .create = create_sorted,
+    .update = update_sorted,
+    .remove = remove_sorted,
+    .query = query_sorted,
+    .print_stats = print_sorted_stats,
+};
@@ -0,0 +1,141 @@
+// The unsorted engines: pooled Orders in an IndexedBook, each side sorted
+// only when it is queried. The backends differ only in the sort.
+
+#include <stdlib.h>
+
+#include "indexed_book.h"
+#include "order_pool.h"
+#include "orderbook.h"
+#include "qsort_orders.h"
+#include "radix_sort.h"
+#include "radix_sort_byte.h"
+#include "stats.h"
+
+typedef struct {
+  IndexedBook book;
+  OrderPool pool;
+  BookSideSort sort_bids;
+  BookSideSort sort_asks;
+} UnsortedBook;
+
+// ---------- Initialization and Cleanup ----------
+
+static void *init_unsorted(BookSideSort sort_bids, BookSideSort sort_asks) {
+  UnsortedBook *ub = malloc(sizeof *ub);
+  if (!ub) {
+    perror("malloc unsorted book");
+    exit(1);
+  }
+  init_indexed_book(&ub->book);
+  init_order_pool(&ub->pool, 1024); // Preallocate blocks of 1024 orders
+  ub->sort_bids = sort_bids;
+  ub->sort_asks = sort_asks;
+  return ub;
+}
+
+static void *init_qsort(void) {
+  return init_unsorted(sort_bids_qsort, sort_asks_qsort);
+}
+
+static void *init_radix(void) {
+  return init_unsorted(sort_bids_range, sort_asks_range);
+}
+
+static void *init_radix_bytes(void) {
+  return init_unsorted(sort_bids_range_bytes, sort_asks_range_bytes);
+}
+
+static void free_unsorted(void *impl) {
+  UnsortedBook *ub = impl;
+  free_indexed_book(&ub->book);
+  free_order_pool(&ub->pool);
+  free(ub);
+}
+
+// ---------- Orders ----------
+
+static void create_unsorted(void *impl, Order order) {
+  UnsortedBook *ub = impl;
+  add_book_order(&ub->book,
+                 allocate_order(&ub->pool, order.order_id, order.order_type,
+                                order.price, order.quantity));
+}
+
+static void update_unsorted(void *impl, int order_id, int price) {
+  UnsortedBook *ub = impl;
+  Order *order = find_book_order(&ub->book, order_id);
+  if (order)
+    order->price = price;
+}
+
+static void remove_unsorted(void *impl, int order_id) {
+  UnsortedBook *ub = impl;
+  Order *order = remove_book_order(&ub->book, order_id);
+  if (order)
+    release_order(&ub->pool, order);
+}
+
+static void prefetch_unsorted(void *impl, int order_id, int stage) {
+  id_index_prefetch(&((UnsortedBook *)impl)->book.index, order_id, stage);
+}
+
+// ---------- Queries ----------
+
+static size_t query_unsorted(void *impl, OrderType side, ObVisitor visit,
+                             void *ctx) {
+  UnsortedBook *ub = impl;
+  BookSide *orders = side == ORDER_BUY ? &ub->book.buys : &ub->book.sells;
+  if (orders->size == 0)
+    return 0;
+
+  sort_book_side(&ub->book, orders,
+                 side == ORDER_BUY ? ub->sort_bids : ub->sort_asks);
+  if (visit)
+    for (size_t i = 0; i < orders->size; i++)
+      visit(orders->data[i], ctx);
+  return orders->size;
+}
+
+static void print_unsorted_stats(const void *impl, FILE *out) {
+  const UnsortedBook *ub = impl;
+  print_book_stats(&ub->book, out);
+  print_pool_stats(&ub->pool, out);
+}
+
+// ---------- Backends ----------
+
+const ObBackend ob_unsorted_qsort_backend = {
+    .name = "unsorted_qsort",
+    .init_book = init_qsort,
+    .free_book = free_unsorted,
+    .create = create_unsorted,
+    .update = update_unsorted,
+    .remove = remove_unsorted,
+    .query = query_unsorted,
+    .print_stats = print_unsorted_stats,
+    .prefetch = prefetch_unsorted,
+};
+
+const ObBackend ob_unsorted_radix_backend = {
+    .name = "unsorted_radix",
+    .init_book = init_radix,
+    .free_book = free_unsorted,
+    .create = create_unsorted,
+    .update = update_unsorted,
+    .remove = remove_unsorted,
+    .query = query_unsorted,
+    .print_stats = print_unsorted_stats,
+    .prefetch = prefetch_unsorted,
+};
+
+const ObBackend ob_unsorted_radix_bytes_backend = {
+    .name = "unsorted_radix_bytes",
+    .init_book = init_radix_bytes,
+    .free_book = free_unsorted,
+    .create = create_unsorted,
+    .update = update_unsorted,
+    .remove = remove_unsorted,
+    .query = query_unsorted,
+    .print_stats = print_unsorted_stats,
+    .prefetch = prefetch_unsorted,
+};
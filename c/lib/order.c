@@ -1,14 +1,22 @@
 #include "order.h"
+#include "stats.h"
 #include <stdio.h>
 
 static const char *order_type_to_str(OrderType type) {
   return (type == ORDER_BUY) ? "Buy" : "Sell";
 }
 
-void print_order(const Order *order) {
-  printf("%s %d %d\n", order_type_to_str(order->order_type), order->price,
-         order->quantity);
+void print_order(FILE *out, const Order *order) {
+  engine_stats.bytes_written +=
+      fprintf(out, "%s %d %d\n", order_type_to_str(order->order_type),
+              order->price, order->quantity);
+}
+int format_order(char *buf, size_t size, const Order *order) {
+  return snprintf(buf, size, "%s %d %d\n",
+                  order_type_to_str(order->order_type), order->price,
+                  order->quantity);
 }
+
 void print_order_full(const Order *order) {
   printf("Order ID: %d, Type: %s, Price: %d, Quantity: %d\n", order->order_id,
          order->order_type == ORDER_BUY ? "BUY" : "SELL", order->price,
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <stddef.h>
 #include <stdio.h>
 
 typedef enum { ORDER_BUY, ORDER_SELL } OrderType;
@@ -19,5 +20,8 @@ static inline Order make_order(int order_id, OrderType order_type, int price,
                  .quantity = quantity};
 }
 
-void print_order(const Order *order);
+void print_order(FILE *out, const Order *order);
+// Write the line print_order prints into buf; returns its length as
+// snprintf does
+int format_order(char *buf, size_t size, const Order *order);
 void print_order_full(const Order *order);
\ No newline at end of file
@@ -2,18 +2,16 @@
 
 #include <stdio.h>
 
+#include "arena.h"
+
 void init_order_array(OrderArray *arr) {
   arr->size = 0;
-  arr->capacity = 4;
-  arr->data = malloc(arr->capacity * sizeof(Order));
-  if (!arr->data) {
-    perror("malloc");
-    exit(1);
-  }
+  arr->capacity = capacity_hint(4);
+  arr->data = arena_alloc(arr->capacity * sizeof(Order));
 }
 
 void free_order_array(OrderArray *arr) {
-  free(arr->data);
+  arena_free(arr->data);
   arr->data = NULL;
   arr->size = arr->capacity = 0;
 }
@@ -21,12 +19,8 @@ void free_order_array(OrderArray *arr) {
 void append_order(OrderArray *arr, Order order) {
   if (arr->size == arr->capacity) {
     arr->capacity *= 2;
-    Order *new_data = realloc(arr->data, arr->capacity * sizeof(Order));
-    if (!new_data) {
-      perror("realloc");
-      exit(1);
-    }
-    arr->data = new_data;
+    arr->data = arena_grow(arr->data, arr->size * sizeof(Order),
+                           arr->capacity * sizeof(Order));
   }
   arr->data[arr->size++] = order;
 }
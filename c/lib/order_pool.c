@@ -7,6 +7,8 @@ void init_order_pool(OrderPool *pool, size_t block_capacity) {
   pool->blocks = NULL;
   pool->free_list = NULL;
   pool->block_capacity = block_capacity;
+  pool->block_count = 0;
+  pool->live = 0;
 }
 
 void free_order_pool(OrderPool *pool) {
@@ -19,6 +21,8 @@ void free_order_pool(OrderPool *pool) {
   }
   pool->blocks = NULL;
   pool->free_list = NULL;
+  pool->block_count = 0;
+  pool->live = 0;
 }
 
 static OrderBlock *allocate_block(size_t capacity) {
@@ -59,10 +63,25 @@ Order *allocate_order(OrderPool *pool, int order_id, int order_type, int price,
       }
       new_block->next = pool->blocks;
       pool->blocks = new_block;
+      pool->block_count++;
     }
     node = &pool->blocks->nodes[pool->blocks->used++];
   }
 
-  node->order = (Order){order_id, order_type, price, quantity};
+  node->order = make_order(order_id, (OrderType)order_type, price, quantity);
+  pool->live++;
   return &node->order;
 }
+
+void release_order(OrderPool *pool, Order *order) {
+  // order is the first member, so the node starts at the same address
+  OrderNode *node = (OrderNode *)order;
+  node->next_free = pool->free_list;
+  pool->free_list = node;
+  pool->live--;
+}
+
+void print_pool_stats(const OrderPool *pool, FILE *out) {
+  fprintf(out, "pool:          %zu blocks of %zu, %zu live orders\n",
+          pool->block_count, pool->block_capacity, pool->live);
+}
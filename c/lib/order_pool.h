@@ -4,6 +4,7 @@
 
 #include "order.h"
 #include <stddef.h>
+#include <stdio.h>
 
 typedef struct OrderNode {
   Order order;
@@ -21,9 +22,16 @@ typedef struct {
   OrderBlock *blocks;
   OrderNode *free_list;
   size_t block_capacity;
+
+  // Statistics
+  size_t block_count;
+  size_t live; // orders handed out and not yet released
 } OrderPool;
 
 void init_order_pool(OrderPool *pool, size_t block_capacity);
 void free_order_pool(OrderPool *pool);
 Order *allocate_order(OrderPool *pool, int order_id, int order_type, int price,
                       int quantity);
+// Return an order to the pool's free list; it must come from allocate_order.
+void release_order(OrderPool *pool, Order *order);
+void print_pool_stats(const OrderPool *pool, FILE *out);
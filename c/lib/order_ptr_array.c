@@ -3,20 +3,18 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "arena.h"
+
 #define INITIAL_CAPACITY 8
 
 void init_order_ptr_array(OrderPtrArray *arr) {
   arr->size = 0;
-  arr->capacity = INITIAL_CAPACITY;
-  arr->data = malloc(arr->capacity * sizeof(Order *));
-  if (!arr->data) {
-    perror("malloc OrderPtrArray");
-    exit(EXIT_FAILURE);
-  }
+  arr->capacity = capacity_hint(INITIAL_CAPACITY);
+  arr->data = arena_alloc(arr->capacity * sizeof(Order *));
 }
 
 void free_order_ptr_array(OrderPtrArray *arr) {
-  free(arr->data);
+  arena_free(arr->data);
   arr->data = NULL;
   arr->size = 0;
   arr->capacity = 0;
@@ -25,11 +23,8 @@ void free_order_ptr_array(OrderPtrArray *arr) {
 void append_order_ptr(OrderPtrArray *arr, Order *order) {
   if (arr->size == arr->capacity) {
     arr->capacity *= 2;
-    arr->data = realloc(arr->data, arr->capacity * sizeof(Order *));
-    if (!arr->data) {
-      perror("realloc OrderPtrArray");
-      exit(EXIT_FAILURE);
-    }
+    arr->data = arena_grow(arr->data, arr->size * sizeof(Order *),
+                           arr->capacity * sizeof(Order *));
   }
   arr->data[arr->size++] = order;
 }
@@ -0,0 +1,82 @@
+#include "orderbook.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#ifndef OB_BACKEND
+#define OB_BACKEND unsorted_radix
+#endif
+#define OB_CONCAT(prefix, name, suffix) prefix##name##suffix
+#define OB_BACKEND_SYMBOL(name) OB_CONCAT(ob_, name, _backend)
+
+struct OrderBook {
+  const ObBackend *backend;
+  void *impl;
+  int next_id;
+};
+
+// ---------- Initialization and Cleanup ----------
+
+OrderBook *ob_new(const ObBackend *backend) {
+  OrderBook *book = malloc(sizeof *book);
+  if (!book) {
+    perror("malloc order book");
+    exit(1);
+  }
+  book->backend = backend ? backend : &OB_BACKEND_SYMBOL(OB_BACKEND);
+  book->impl = book->backend->init_book();
+  book->next_id = 0;
+  return book;
+}
+
+void ob_free(OrderBook *book) {
+  book->backend->free_book(book->impl);
+  free(book);
+}
+
+const ObBackend *ob_backend(const OrderBook *book) { return book->backend; }
+
+// ---------- Orders ----------
+
+int ob_create(OrderBook *book, OrderType side, int price, int quantity) {
+  int order_id = book->next_id++;
+  book->backend->create(book->impl,
+                        make_order(order_id, side, price, quantity));
+  return order_id;
+}
+
+void ob_skip_id(OrderBook *book) { book->next_id++; }
+
+static inline bool known_id(const OrderBook *book, int order_id) {
+  return order_id >= 0 && order_id < book->next_id;
+}
+
+void ob_update(OrderBook *book, int order_id, int price) {
+  if (known_id(book, order_id))
+    book->backend->update(book->impl, order_id, price);
+}
+
+void ob_remove(OrderBook *book, int order_id) {
+  if (known_id(book, order_id))
+    book->backend->remove(book->impl, order_id);
+}
+
+void ob_prefetch(OrderBook *book, int order_id, int stage) {
+  if (book->backend->prefetch && known_id(book, order_id))
+    book->backend->prefetch(book->impl, order_id, stage);
+}
+
+// ---------- Queries ----------
+
+size_t ob_bids(OrderBook *book, ObVisitor visit, void *ctx) {
+  return book->backend->query(book->impl, ORDER_BUY, visit, ctx);
+}
+
+size_t ob_asks(OrderBook *book, ObVisitor visit, void *ctx) {
+  return book->backend->query(book->impl, ORDER_SELL, visit, ctx);
+}
+
+void ob_print_stats(const OrderBook *book, FILE *out) {
+  if (book->backend->print_stats)
+    book->backend->print_stats(book->impl, out);
+}
@@ -0,0 +1,78 @@
+// Embeddable order book.
+//
+// An OrderBook is one of the engines behind a small API, so a program can
+// keep a book in process instead of piping text events to one of the
+// command-line engines. Those engines are themselves thin drivers over
+// this API (see driver.h), so both run the same code.
+//
+// The engine is chosen by an ObBackend, a table of functions over the
+// engine's own state. The library provides the unsorted engines (qsort
+// or a radix sort on query) and the sorted-list engine; ob_new(NULL)
+// picks the one named by OB_BACKEND at compile time (make OB_BACKEND=
+// sorted in c/lib), and the unsorted radix engine otherwise. Engines
+// that live outside the library plug in the same way.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "order.h"
+
+typedef struct OrderBook OrderBook;
+
+// Called for each order of a side, best first. The order is the book's
+// own copy where the engine keeps Orders, so it is only valid during the
+// call.
+typedef void (*ObVisitor)(const Order *order, void *ctx);
+
+typedef struct {
+  const char *name;
+  void *(*init_book)(void);
+  void (*free_book)(void *impl);
+  void (*create)(void *impl, Order order);
+  // Only called with ids that have been created, live or not
+  void (*update)(void *impl, int order_id, int price);
+  void (*remove)(void *impl, int order_id);
+  // Bring the side into price order and visit it, if visit is not NULL.
+  // Returns the number of orders on the side.
+  size_t (*query)(void *impl, OrderType side, ObVisitor visit, void *ctx);
+  void (*print_stats)(const void *impl, FILE *out); // may be NULL
+  // Prefetch hint for an upcoming update or removal of order_id, given
+  // in stages 0 .. OB_PREFETCH_STAGES-1, some events apart; may be NULL
+  void (*prefetch)(void *impl, int order_id, int stage);
+} ObBackend;
+
+#define OB_PREFETCH_STAGES 3
+
+extern const ObBackend ob_unsorted_qsort_backend;
+extern const ObBackend ob_unsorted_radix_backend;
+extern const ObBackend ob_unsorted_radix_bytes_backend;
+extern const ObBackend ob_sorted_backend;
+
+// NULL selects the compile-time default backend
+OrderBook *ob_new(const ObBackend *backend);
+void ob_free(OrderBook *book);
+const ObBackend *ob_backend(const OrderBook *book);
+
+// Add an order and return its id. Ids are handed out sequentially from
+// zero, like the ids of CREATE events.
+int ob_create(OrderBook *book, OrderType side, int price, int quantity);
+// Use up the next id without creating an order, for a caller that drops
+// a CREATE whose order is removed before anything can see it. The caller
+// must not update or remove the id afterwards.
+void ob_skip_id(OrderBook *book);
+// Updates and removals of unknown ids are ignored
+void ob_update(OrderBook *book, int order_id, int price);
+void ob_remove(OrderBook *book, int order_id);
+// Hint that order_id is about to be updated or removed (see prefetch in
+// ObBackend). Only a hint: it changes nothing in the book.
+void ob_prefetch(OrderBook *book, int order_id, int stage);
+
+// Visit the bids (highest price first) or asks (lowest first) and return
+// how many there are. With a NULL visitor the side is still sorted, as a
+// query would, but nothing is visited.
+size_t ob_bids(OrderBook *book, ObVisitor visit, void *ctx);
+size_t ob_asks(OrderBook *book, ObVisitor visit, void *ctx);
+
+void ob_print_stats(const OrderBook *book, FILE *out);
@@ -0,0 +1,70 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "packed_order.h"
+#include "stats.h"
+#include "timing.h"
+
+// Side, price and quantity make up the top 36 bits: five 8-bit digits,
+// the last one only partly used
+#define DIGIT_BITS 8
+#define DIGIT_BUCKETS (1 << DIGIT_BITS)
+#define DIGIT_PASSES 5
+
+// ---------- Counting Sort ----------
+
+static inline size_t digit(PackedOrder w, unsigned pass) {
+  return (w >> (PACKED_QUANTITY_SHIFT + pass * DIGIT_BITS)) &
+         (DIGIT_BUCKETS - 1);
+}
+
+static void counting_sort(const PackedOrder *src, PackedOrder *dst,
+                          size_t size, unsigned pass, size_t *count) {
+  size_t offset = 0;
+  for (size_t b = 0; b < DIGIT_BUCKETS; b++) {
+    size_t c = count[b];
+    count[b] = offset;
+    offset += c;
+  }
+  for (size_t i = 0; i < size; i++)
+    dst[count[digit(src[i], pass)]++] = src[i];
+}
+
+// ---------- Public Interface ----------
+
+void sort_packed_orders(PackedOrder *data, size_t size) {
+  if (size < 2)
+    return;
+  uint64_t start = now_ticks();
+
+  PackedOrder *tmp = malloc(size * sizeof *tmp);
+  if (!tmp) {
+    perror("malloc");
+    exit(1);
+  }
+
+  // Count every digit in one read, then skip the passes where all keys
+  // share a digit. The top digit holds the side and the high price bits,
+  // so it is nearly always skipped, as are more of the price digits for
+  // a book clustered around its mid price.
+  size_t count[DIGIT_PASSES][DIGIT_BUCKETS] = {{0}};
+  for (size_t i = 0; i < size; i++)
+    for (unsigned pass = 0; pass < DIGIT_PASSES; pass++)
+      count[pass][digit(data[i], pass)]++;
+
+  PackedOrder *src = data, *dst = tmp;
+  for (unsigned pass = 0; pass < DIGIT_PASSES; pass++) {
+    if (count[pass][digit(data[0], pass)] == size)
+      continue;
+    counting_sort(src, dst, size, pass, count[pass]);
+    PackedOrder *swap = src;
+    src = dst;
+    dst = swap;
+  }
+  if (src != data)
+    memcpy(data, src, size * sizeof *data);
+
+  free(tmp);
+  count_sort(size, now_ticks() - start);
+}
@@ -0,0 +1,216 @@
+#include "parallel_format.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "stats.h"
+
+// "\tSell -2147483648 -2147483648\n"
+#define MAX_LINE 30
+
+// ---------- Initialization and Cleanup ----------
+
+void init_parallel_formatter(ParallelFormatter *fmt, unsigned threads,
+                             size_t threshold) {
+  if (threads == 0)
+    threads = 1;
+  if (threads > FORMAT_MAX_THREADS)
+    threads = FORMAT_MAX_THREADS;
+  fmt->threads = threads;
+  fmt->threshold = threshold;
+  init_order_array(&fmt->orders);
+  fmt->buffers = calloc(fmt->threads, sizeof *fmt->buffers);
+  fmt->iov = malloc((fmt->threads + 1) * sizeof *fmt->iov);
+  if (!fmt->buffers || !fmt->iov) {
+    perror("malloc format buffers");
+    exit(EXIT_FAILURE);
+  }
+  fmt->workers = NULL;
+  fmt->tids = NULL;
+  fmt->started = false;
+  pthread_mutex_init(&fmt->lock, NULL);
+  pthread_cond_init(&fmt->start, NULL);
+  pthread_cond_init(&fmt->done, NULL);
+  fmt->generation = 0;
+  fmt->busy = 0;
+  fmt->stopping = false;
+  fmt->parallel_queries = 0;
+}
+
+void free_parallel_formatter(ParallelFormatter *fmt) {
+  if (fmt->started) {
+    pthread_mutex_lock(&fmt->lock);
+    fmt->stopping = true;
+    pthread_cond_broadcast(&fmt->start);
+    pthread_mutex_unlock(&fmt->lock);
+    for (unsigned i = 1; i < fmt->threads; i++)
+      pthread_join(fmt->tids[i], NULL);
+  }
+  free(fmt->workers);
+  free(fmt->tids);
+  free(fmt->iov);
+  pthread_mutex_destroy(&fmt->lock);
+  pthread_cond_destroy(&fmt->start);
+  pthread_cond_destroy(&fmt->done);
+  free_order_array(&fmt->orders);
+  for (unsigned i = 0; i < fmt->threads; i++)
+    free(fmt->buffers[i].data);
+  free(fmt->buffers);
+}
+
+void collect_formatted(const Order *order, void *ctx) {
+  append_order(&((ParallelFormatter *)ctx)->orders, *order);
+}
+
+// ---------- Formatting ----------
+
+static void format_range(FormatBuffer *buf, const Order *orders,
+                         size_t count) {
+  size_t needed = count * MAX_LINE + 1; // snprintf's terminator
+  if (buf->capacity < needed) {
+    free(buf->data);
+    buf->data = malloc(needed);
+    if (!buf->data) {
+      perror("malloc format buffer");
+      exit(EXIT_FAILURE);
+    }
+    buf->capacity = needed;
+  }
+  char *p = buf->data;
+  for (size_t i = 0; i < count; i++) {
+    *p++ = '\t';
+    p += format_order(p, MAX_LINE, &orders[i]);
+  }
+  buf->size = (size_t)(p - buf->data);
+}
+
+// Range `range` of `threads` near-equal ranges of the result
+static void format_part(ParallelFormatter *fmt, unsigned range) {
+  size_t n = fmt->orders.size;
+  size_t begin = n * range / fmt->threads;
+  size_t end = n * (range + 1) / fmt->threads;
+  format_range(&fmt->buffers[range], fmt->orders.data + begin, end - begin);
+}
+
+// ---------- Workers ----------
+
+static void *format_worker(void *arg) {
+  FormatWorker *w = arg;
+  ParallelFormatter *fmt = w->fmt;
+  uint64_t seen = 0;
+  pthread_mutex_lock(&fmt->lock);
+  for (;;) {
+    while (!fmt->stopping && fmt->generation == seen)
+      pthread_cond_wait(&fmt->start, &fmt->lock);
+    if (fmt->stopping)
+      break;
+    seen = fmt->generation;
+    pthread_mutex_unlock(&fmt->lock);
+
+    format_part(fmt, w->range);
+
+    pthread_mutex_lock(&fmt->lock);
+    if (--fmt->busy == 0)
+      pthread_cond_signal(&fmt->done);
+  }
+  pthread_mutex_unlock(&fmt->lock);
+  return NULL;
+}
+
+static void start_workers(ParallelFormatter *fmt) {
+  fmt->workers = malloc(fmt->threads * sizeof *fmt->workers);
+  fmt->tids = malloc(fmt->threads * sizeof *fmt->tids);
+  if (!fmt->workers || !fmt->tids) {
+    perror("malloc format workers");
+    exit(EXIT_FAILURE);
+  }
+  for (unsigned i = 1; i < fmt->threads; i++) {
+    fmt->workers[i] = (FormatWorker){fmt, i};
+    if (pthread_create(&fmt->tids[i], NULL, format_worker,
+                       &fmt->workers[i]) != 0) {
+      perror("pthread_create");
+      exit(EXIT_FAILURE);
+    }
+  }
+  fmt->started = true;
+}
+
+// Format every range: the workers take ranges 1 .. threads-1 while this
+// thread does range 0, then wait for them
+static void format_parallel(ParallelFormatter *fmt) {
+  if (!fmt->started)
+    start_workers(fmt);
+  pthread_mutex_lock(&fmt->lock);
+  fmt->busy = fmt->threads - 1;
+  fmt->generation++;
+  pthread_cond_broadcast(&fmt->start);
+  pthread_mutex_unlock(&fmt->lock);
+
+  format_part(fmt, 0);
+
+  pthread_mutex_lock(&fmt->lock);
+  while (fmt->busy > 0)
+    pthread_cond_wait(&fmt->done, &fmt->lock);
+  pthread_mutex_unlock(&fmt->lock);
+}
+
+// ---------- Writing ----------
+
+// writev all of iov to fd, picking up after partial writes
+static void write_all(int fd, struct iovec *iov, int count) {
+  while (count > 0) {
+    ssize_t n = writev(fd, iov, count);
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      perror("writev");
+      exit(EXIT_FAILURE);
+    }
+    while (count > 0 && (size_t)n >= iov->iov_len) {
+      n -= (ssize_t)iov->iov_len;
+      iov++, count--;
+    }
+    if (count > 0) {
+      iov->iov_base = (char *)iov->iov_base + n;
+      iov->iov_len -= (size_t)n;
+    }
+  }
+}
+
+void write_formatted(ParallelFormatter *fmt, const char *trailer, FILE *out) {
+  unsigned ranges = fmt->threads;
+  format_parallel(fmt);
+  fmt->parallel_queries++;
+  fmt->orders.size = 0;
+
+  struct iovec *iov = fmt->iov;
+  size_t total = strlen(trailer);
+  for (unsigned i = 0; i < ranges; i++) {
+    iov[i] = (struct iovec){fmt->buffers[i].data, fmt->buffers[i].size};
+    total += fmt->buffers[i].size;
+  }
+  iov[ranges] = (struct iovec){(void *)trailer, strlen(trailer)};
+  engine_stats.bytes_written += total;
+
+  // Streams without a descriptor (the --async-io writer) take the
+  // buffers one by one
+  int fd = fileno(out);
+  if (fd < 0) {
+    for (unsigned i = 0; i <= ranges; i++)
+      fwrite(iov[i].iov_base, 1, iov[i].iov_len, out);
+    return;
+  }
+  fflush(out);
+  write_all(fd, iov, (int)ranges + 1);
+}
+
+// ---------- Statistics ----------
+
+void print_parallel_format_stats(const ParallelFormatter *fmt, FILE *out) {
+  fprintf(out,
+          "parallel format: %u threads, threshold %zu orders, %llu queries "
+          "split\n",
+          fmt->threads, fmt->threshold,
+          (unsigned long long)fmt->parallel_queries);
+}
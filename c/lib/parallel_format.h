@@ -0,0 +1,80 @@
+// Parallel formatting of large query results (--format-threads).
+//
+// The driver prints the first `threshold` orders of a side through
+// stdio as usual, so sides below the threshold never reach the
+// formatter. The orders after those are collected, best first, and
+// handed to write_formatted. It splits them into one contiguous range
+// per thread, formats every range into its own buffer, flushes the
+// stream and writes the buffers in order with a single writev, so the
+// bytes are the same as printing them.
+//
+// The calling thread formats the first range itself. The other threads
+// are started at the first large result and then kept, waiting for the
+// next one, until the formatter is freed.
+//
+// The buffers and the closing newline go out in one writev, which takes
+// at most IOV_MAX pieces, so the thread count is capped at
+// FORMAT_MAX_THREADS.
+
+#pragma once
+
+#include <limits.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/uio.h>
+
+#include "order_array.h"
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+#define FORMAT_MAX_THREADS (IOV_MAX - 1)
+
+typedef struct {
+  char *data;
+  size_t size, capacity;
+} FormatBuffer;
+
+typedef struct ParallelFormatter ParallelFormatter;
+
+typedef struct {
+  ParallelFormatter *fmt;
+  unsigned range;
+} FormatWorker;
+
+struct ParallelFormatter {
+  unsigned threads;
+  size_t threshold; // orders printed through stdio before collecting
+  OrderArray orders; // the collected rest of the side, in visiting order
+  FormatBuffer *buffers; // one per range
+  struct iovec *iov;     // buffers and closing newline
+
+  // Workers for ranges 1 .. threads-1, started on first use
+  FormatWorker *workers;
+  pthread_t *tids;
+  bool started;
+  pthread_mutex_t lock;
+  pthread_cond_t start, done;
+  uint64_t generation; // bumped for every result
+  unsigned busy;       // workers still formatting the current one
+  bool stopping;
+
+  // Statistics
+  uint64_t parallel_queries;
+};
+
+void init_parallel_formatter(ParallelFormatter *fmt, unsigned threads,
+                             size_t threshold);
+void free_parallel_formatter(ParallelFormatter *fmt);
+
+// ObVisitor appending the order to fmt->orders
+void collect_formatted(const Order *order, void *ctx);
+
+// Write the collected orders' lines and then trailer to out, and clear
+// the result for the next query
+void write_formatted(ParallelFormatter *fmt, const char *trailer, FILE *out);
+
+void print_parallel_format_stats(const ParallelFormatter *fmt, FILE *out);
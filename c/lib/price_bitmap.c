@@ -0,0 +1,80 @@
+#include <string.h>
+
+#include "price_bitmap.h"
+
+// Lowest and highest set bit of a non-zero word
+static inline unsigned first_bit(uint64_t w) {
+  return (unsigned)__builtin_ctzll(w);
+}
+static inline unsigned last_bit(uint64_t w) {
+  return 63u - (unsigned)__builtin_clzll(w);
+}
+
+// Bits at positions >= i, and at positions <= i
+static inline uint64_t bits_from(unsigned i) { return ~UINT64_C(0) << i; }
+static inline uint64_t bits_upto(unsigned i) {
+  return ~UINT64_C(0) >> (63 - i);
+}
+
+void init_price_bitmap(PriceBitmap *bm) { memset(bm, 0, sizeof *bm); }
+
+int price_bitmap_next(const PriceBitmap *bm, int price) {
+  if (price > PRICE_MAX)
+    return PRICE_NONE;
+  if (price < PRICE_MIN)
+    price = PRICE_MIN;
+  unsigned level = (unsigned)(price - PRICE_MIN);
+
+  // Same leaf word
+  unsigned leaf = level / 64;
+  uint64_t w = bm->leaf[leaf] & bits_from(level % 64);
+  if (w)
+    return (int)(leaf * 64 + first_bit(w)) + PRICE_MIN;
+
+  // A later leaf word under the same mid word
+  leaf++;
+  unsigned mid = leaf / 64;
+  w = leaf < PRICE_BITMAP_LEAVES ? bm->mid[mid] & bits_from(leaf % 64) : 0;
+  if (!w) {
+    // A later mid word
+    mid++;
+    w = mid < PRICE_BITMAP_MIDS ? bm->top & bits_from(mid) : 0;
+    if (!w)
+      return PRICE_NONE;
+    mid = first_bit(w);
+    w = bm->mid[mid];
+  }
+  leaf = mid * 64 + first_bit(w);
+  return (int)(leaf * 64 + first_bit(bm->leaf[leaf])) + PRICE_MIN;
+}
+
+int price_bitmap_prev(const PriceBitmap *bm, int price) {
+  if (price < PRICE_MIN)
+    return PRICE_NONE;
+  if (price > PRICE_MAX)
+    price = PRICE_MAX;
+  unsigned level = (unsigned)(price - PRICE_MIN);
+
+  unsigned leaf = level / 64;
+  uint64_t w = bm->leaf[leaf] & bits_upto(level % 64);
+  if (w)
+    return (int)(leaf * 64 + last_bit(w)) + PRICE_MIN;
+
+  if (leaf == 0)
+    return PRICE_NONE;
+  leaf--;
+  unsigned mid = leaf / 64;
+  w = bm->mid[mid] & bits_upto(leaf % 64);
+  if (!w) {
+    if (mid == 0)
+      return PRICE_NONE;
+    mid--;
+    w = bm->top & bits_upto(mid);
+    if (!w)
+      return PRICE_NONE;
+    mid = last_bit(w);
+    w = bm->mid[mid];
+  }
+  leaf = mid * 64 + last_bit(w);
+  return (int)(leaf * 64 + last_bit(bm->leaf[leaf])) + PRICE_MIN;
+}
@@ -0,0 +1,70 @@
+// Three-level 64-ary bitmap over the price domain.
+//
+// A bit per price level says whether the level is occupied, and each
+// word of a level above summarises 64 words below it, much like a
+// van Emde Boas tree with a fixed fan-out. Finding the next or previous
+// occupied level touches at most one word per level going up and one
+// per level coming down, using count-trailing/leading-zeros (tzcnt and
+// lzcnt with -mbmi -mlzcnt), so the cost does not depend on how far
+// away the level is.
+//
+// Prices are those the simulators produce, PRICE_MIN..PRICE_MAX; bit
+// price - PRICE_MIN stands for a level. Engines that bucket orders by
+// price can keep one of these next to their level array and use it for
+// best-price maintenance and for iterating the non-empty levels:
+//
+//   for (int p = price_bitmap_next(bm, PRICE_MIN); p != PRICE_NONE;
+//        p = price_bitmap_next(bm, p + 1))
+
+#pragma once
+
+#include <limits.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define PRICE_MIN (-10000)
+#define PRICE_MAX 10000
+#define PRICE_LEVELS (PRICE_MAX - PRICE_MIN + 1)
+#define PRICE_NONE INT_MIN // returned when there is no such level
+
+#define PRICE_BITMAP_LEAVES ((PRICE_LEVELS + 63) / 64)
+#define PRICE_BITMAP_MIDS ((PRICE_BITMAP_LEAVES + 63) / 64)
+
+typedef struct {
+  uint64_t top;                       // bit i: mid[i] is non-zero
+  uint64_t mid[PRICE_BITMAP_MIDS];    // bit j of mid[i]: leaf[64i+j]
+  uint64_t leaf[PRICE_BITMAP_LEAVES]; // bit k of leaf[i]: level 64i+k
+} PriceBitmap;
+
+_Static_assert(PRICE_BITMAP_MIDS <= 64, "price domain too large");
+
+void init_price_bitmap(PriceBitmap *bm);
+// Smallest occupied price >= price, or PRICE_NONE
+int price_bitmap_next(const PriceBitmap *bm, int price);
+// Largest occupied price <= price, or PRICE_NONE
+int price_bitmap_prev(const PriceBitmap *bm, int price);
+
+static inline bool price_bitmap_test(const PriceBitmap *bm, int price) {
+  unsigned level = (unsigned)(price - PRICE_MIN);
+  return (bm->leaf[level / 64] >> (level % 64)) & 1;
+}
+
+static inline void price_bitmap_set(PriceBitmap *bm, int price) {
+  unsigned level = (unsigned)(price - PRICE_MIN);
+  unsigned leaf = level / 64;
+  bm->leaf[leaf] |= UINT64_C(1) << (level % 64);
+  bm->mid[leaf / 64] |= UINT64_C(1) << (leaf % 64);
+  bm->top |= UINT64_C(1) << (leaf / 64);
+}
+
+static inline void price_bitmap_clear(PriceBitmap *bm, int price) {
+  unsigned level = (unsigned)(price - PRICE_MIN);
+  unsigned leaf = level / 64;
+  bm->leaf[leaf] &= ~(UINT64_C(1) << (level % 64));
+  if (bm->leaf[leaf])
+    return;
+  bm->mid[leaf / 64] &= ~(UINT64_C(1) << (leaf % 64));
+  if (bm->mid[leaf / 64])
+    return;
+  bm->top &= ~(UINT64_C(1) << (leaf / 64));
+}
@@ -0,0 +1,38 @@
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "qsort_orders.h"
+#include "stats.h"
+#include "timing.h"
+
+// ---------- Sorting ----------
+
+static int cmp_asc(const void *a, const void *b) {
+  const Order *o1 = *(const Order **)a;
+  const Order *o2 = *(const Order **)b;
+  if (o1->price != o2->price)
+    return o1->price - o2->price;
+  return o1->quantity - o2->quantity;
+}
+
+static int cmp_desc(const void *a, const void *b) {
+  const Order *o1 = *(const Order **)a;
+  const Order *o2 = *(const Order **)b;
+  if (o1->price != o2->price)
+    return o2->price - o1->price;
+  return o2->quantity - o1->quantity;
+}
+
+void sort_asks_qsort(Order ***begin, Order **end) {
+  size_t size = end - *begin;
+  uint64_t start = now_ticks();
+  qsort(*begin, size, sizeof(Order *), cmp_asc);
+  count_sort(size, now_ticks() - start);
+}
+
+void sort_bids_qsort(Order ***begin, Order **end) {
+  size_t size = end - *begin;
+  uint64_t start = now_ticks();
+  qsort(*begin, size, sizeof(Order *), cmp_desc);
+  count_sort(size, now_ticks() - start);
+}
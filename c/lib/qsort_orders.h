@@ -0,0 +1,7 @@
+#pragma once
+
+#include "order.h"
+
+// qsort-based sorts with the same interface as the radix sorts
+void sort_asks_qsort(Order ***begin, Order **end);
+void sort_bids_qsort(Order ***begin, Order **end);
@@ -1,5 +1,7 @@
 #include "radix_sort.h"
 #include "order.h"
+#include "stats.h"
+#include "timing.h"
 #include <assert.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -60,6 +62,7 @@ void sort_asks_range(Order ***begin, Order **end) {
   size_t size = end - *begin;
   if (size == 0)
     return;
+  uint64_t start = now_ticks();
 
   Order **tmp = malloc(size * sizeof *tmp);
   if (!tmp) {
@@ -73,12 +76,14 @@ void sort_asks_range(Order ***begin, Order **end) {
   memcpy(*begin, tmp, size * sizeof(Order *));
 
   free(tmp);
+  count_sort(size, now_ticks() - start);
 }
 
 void sort_bids_range(Order ***begin, Order **end) {
   size_t size = end - *begin;
   if (size == 0)
     return;
+  uint64_t start = now_ticks();
 
   Order **tmp = malloc(size * sizeof *tmp);
   if (!tmp) {
@@ -95,4 +100,5 @@ void sort_bids_range(Order ***begin, Order **end) {
 
   // Reverse for descending order
   reverse_range(*begin, size);
+  count_sort(size, now_ticks() - start);
 }
\ No newline at end of file
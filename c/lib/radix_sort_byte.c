@@ -6,6 +6,8 @@
 #include <string.h>
 
 #include "radix_sort_byte.h"
+#include "stats.h"
+#include "timing.h"
 
 #define MAX_BUCKETS 256
 #define PRICE_SHIFT 10000
@@ -59,6 +61,7 @@ void sort_asks_range_bytes(Order ***begin, Order **end) {
   size_t size = end - *begin;
   if (size == 0)
     return;
+  uint64_t start = now_ticks();
 
   Order **tmp = malloc(size * sizeof *tmp);
   if (!tmp) {
@@ -81,12 +84,14 @@ void sort_asks_range_bytes(Order ***begin, Order **end) {
   }
 
   free(tmp);
+  count_sort(size, now_ticks() - start);
 }
 
 void sort_bids_range_bytes(Order ***begin, Order **end) {
   size_t size = end - *begin;
   if (size == 0)
     return;
+  uint64_t start = now_ticks();
 
   Order **tmp = malloc(size * sizeof *tmp);
   if (!tmp) {
@@ -110,4 +115,5 @@ void sort_bids_range_bytes(Order ***begin, Order **end) {
 
   reverse_range(*begin, size);
   free(tmp);
+  count_sort(size, now_ticks() - start);
 }
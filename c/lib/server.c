@@ -0,0 +1,335 @@
+#include "server.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define MAX_EVENTS 64
+#define IN_BUF_SIZE (64 * 1024)
+// Stop reading a client's requests while this much output is pending
+#define OUT_HIGH_WATER (1024 * 1024)
+
+typedef struct {
+  char *data;
+  size_t start, end, capacity;
+} OutBuffer;
+
+typedef struct {
+  int fd;
+  bool greeted; // first line seen
+  bool closing; // peer is done sending; close once output is flushed
+  uint32_t interest;
+  size_t in_len;
+  OutBuffer out;
+  char in[IN_BUF_SIZE];
+} Client;
+
+typedef struct {
+  OrderBook *book;
+  ServerIngest ingest;
+  ServerSync sync;
+  void *ctx;
+  int epoll_fd;
+  int listen_fd;
+  Client *ingest_client;
+  bool had_ingest;
+  size_t connections;
+} Server;
+
+// ---------- Output Buffers ----------
+
+static char *reserve(OutBuffer *out, size_t bytes) {
+  if (out->end + bytes > out->capacity && out->start > 0) {
+    memmove(out->data, out->data + out->start, out->end - out->start);
+    out->end -= out->start;
+    out->start = 0;
+  }
+  if (out->end + bytes > out->capacity) {
+    size_t capacity = out->capacity ? out->capacity : 4096;
+    while (out->end + bytes > capacity)
+      capacity *= 2;
+    out->data = realloc(out->data, capacity);
+    if (!out->data) {
+      perror("realloc client buffer");
+      exit(EXIT_FAILURE);
+    }
+    out->capacity = capacity;
+  }
+  return out->data + out->end;
+}
+
+static void append(OutBuffer *out, const char *text) {
+  size_t len = strlen(text);
+  memcpy(reserve(out, len), text, len);
+  out->end += len;
+}
+
+static inline size_t pending(const OutBuffer *out) {
+  return out->end - out->start;
+}
+
+// ---------- Connections ----------
+
+static void set_interest(Server *server, Client *client) {
+  uint32_t interest = 0;
+  if (!client->closing && pending(&client->out) < OUT_HIGH_WATER)
+    interest |= EPOLLIN;
+  if (pending(&client->out) > 0)
+    interest |= EPOLLOUT;
+  if (interest == client->interest)
+    return;
+  struct epoll_event ev = {.events = interest, .data.ptr = client};
+  if (epoll_ctl(server->epoll_fd, EPOLL_CTL_MOD, client->fd, &ev) != 0) {
+    perror("epoll_ctl");
+    exit(EXIT_FAILURE);
+  }
+  client->interest = interest;
+}
+
+static void accept_clients(Server *server) {
+  for (;;) {
+    int fd = accept(server->listen_fd, NULL, NULL);
+    if (fd < 0) {
+      if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+        perror("accept");
+      return;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    Client *client = calloc(1, sizeof *client);
+    if (!client) {
+      perror("malloc client");
+      exit(EXIT_FAILURE);
+    }
+    client->fd = fd;
+    client->interest = EPOLLIN;
+    struct epoll_event ev = {.events = EPOLLIN, .data.ptr = client};
+    if (epoll_ctl(server->epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+      perror("epoll_ctl");
+      exit(EXIT_FAILURE);
+    }
+    server->connections++;
+  }
+}
+
+static void close_client(Server *server, Client *client) {
+  epoll_ctl(server->epoll_fd, EPOLL_CTL_DEL, client->fd, NULL);
+  close(client->fd);
+  if (client == server->ingest_client)
+    server->ingest_client = NULL;
+  free(client->out.data);
+  free(client);
+  server->connections--;
+}
+
+// Write what the socket takes without blocking. False if the client is
+// gone.
+static bool flush_client(Client *client) {
+  OutBuffer *out = &client->out;
+  while (pending(out) > 0) {
+    ssize_t n = send(client->fd, out->data + out->start, pending(out),
+                     MSG_NOSIGNAL);
+    if (n < 0)
+      return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    out->start += (size_t)n;
+  }
+  out->start = out->end = 0;
+  return true;
+}
+
+// ---------- Requests ----------
+
+// The same lines the engines print for a query
+static void append_order(const Order *order, void *ctx) {
+  OutBuffer *out = ctx;
+  char *line = reserve(out, 64);
+  line[0] = '\t';
+  out->end += 1 + (size_t)format_order(line + 1, 63, order);
+}
+
+static void answer_query(Server *server, Client *client, OrderType side) {
+  if (server->sync)
+    server->sync(server->ctx);
+  append(&client->out, side == ORDER_BUY ? "Bids\n" : "Asks\n");
+  (side == ORDER_BUY ? ob_bids : ob_asks)(server->book, append_order,
+                                          &client->out);
+  append(&client->out, "\n");
+}
+
+static void reply_error(Client *client, const char *reason) {
+  append(&client->out, "ERR ");
+  append(&client->out, reason);
+  append(&client->out, "\n\n");
+}
+
+static void handle_line(Server *server, Client *client, char *line) {
+  size_t len = strlen(line);
+  if (len > 0 && line[len - 1] == '\r')
+    line[len - 1] = '\0';
+
+  if (!client->greeted) {
+    client->greeted = true;
+    if (strcmp(line, "INGEST") == 0) {
+      if (server->ingest_client) {
+        reply_error(client, "ingest connection already open");
+        client->closing = true;
+      } else {
+        server->ingest_client = client;
+        server->had_ingest = true;
+      }
+      return;
+    }
+  }
+
+  Event event;
+  const char *error = parse_event_line(line, &event);
+  if (client == server->ingest_client) {
+    // The event stream is held to the same standard as standard input
+    if (error) {
+      fprintf(stderr, "%s: %s\n", error, line);
+      exit(EXIT_FAILURE);
+    }
+    server->ingest(&event, server->ctx);
+  } else if (error) {
+    reply_error(client, error);
+  } else if (event.type == EVENT_BIDS || event.type == EVENT_ASKS) {
+    answer_query(server, client,
+                 event.type == EVENT_BIDS ? ORDER_BUY : ORDER_SELL);
+  } else {
+    reply_error(client, "orders are only taken on the ingest connection");
+  }
+}
+
+// Handle the complete lines in the input buffer and keep the rest
+static void handle_lines(Server *server, Client *client, bool at_eof) {
+  size_t start = 0;
+  for (;;) {
+    char *newline = memchr(client->in + start, '\n', client->in_len - start);
+    if (!newline)
+      break;
+    *newline = '\0';
+    handle_line(server, client, client->in + start);
+    start = (size_t)(newline - client->in) + 1;
+  }
+  if (at_eof && start < client->in_len) {
+    // A last line without a newline, as fgets would return it
+    client->in[client->in_len] = '\0';
+    handle_line(server, client, client->in + start);
+    start = client->in_len;
+  }
+  memmove(client->in, client->in + start, client->in_len - start);
+  client->in_len -= start;
+}
+
+// One read per readiness, so a busy connection cannot starve the others
+static void read_client(Server *server, Client *client) {
+  // Keep a byte for the terminator of an unfinished last line
+  ssize_t n = read(client->fd, client->in + client->in_len,
+                   IN_BUF_SIZE - 1 - client->in_len);
+  if (n < 0) {
+    if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+      return;
+    client->closing = true;
+    client->out.start = client->out.end = 0;
+    return;
+  }
+  client->in_len += (size_t)n;
+  handle_lines(server, client, n == 0);
+  if (n == 0) {
+    client->closing = true;
+    if (client == server->ingest_client)
+      server->ingest_client = NULL;
+  } else if (client->in_len == IN_BUF_SIZE - 1) {
+    reply_error(client, "line too long");
+    client->closing = true;
+    client->in_len = 0;
+  }
+}
+
+// ---------- Event Loop ----------
+
+static int listen_on(const char *path) {
+  struct sockaddr_un addr = {.sun_family = AF_UNIX};
+  if (strlen(path) >= sizeof addr.sun_path) {
+    fprintf(stderr, "Socket path too long: %s\n", path);
+    exit(EXIT_FAILURE);
+  }
+  strcpy(addr.sun_path, path);
+  unlink(path); // a socket left behind by an earlier run
+
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+  if (fd < 0 || bind(fd, (struct sockaddr *)&addr, sizeof addr) != 0 ||
+      listen(fd, SOMAXCONN) != 0) {
+    perror(path);
+    exit(EXIT_FAILURE);
+  }
+  return fd;
+}
+
+void serve_book(OrderBook *book, const char *socket_path, ServerIngest ingest,
+                ServerSync sync, void *ctx) {
+  Server server = {.book = book, .ingest = ingest, .sync = sync, .ctx = ctx};
+  server.listen_fd = listen_on(socket_path);
+  server.epoll_fd = epoll_create1(0);
+  struct epoll_event ev = {.events = EPOLLIN, .data.ptr = NULL};
+  if (server.epoll_fd < 0 ||
+      epoll_ctl(server.epoll_fd, EPOLL_CTL_ADD, server.listen_fd, &ev) != 0) {
+    perror("epoll");
+    exit(EXIT_FAILURE);
+  }
+
+  struct epoll_event events[MAX_EVENTS];
+  while (!server.had_ingest || server.connections > 0) {
+    int n = epoll_wait(server.epoll_fd, events, MAX_EVENTS, -1);
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      perror("epoll_wait");
+      exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < n; i++) {
+      Client *client = events[i].data.ptr;
+      if (!client) {
+        accept_clients(&server);
+        continue;
+      }
+      if (!client->closing &&
+          (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)))
+        read_client(&server, client);
+      if (!flush_client(client) ||
+          (client->closing && pending(&client->out) == 0)) {
+        close_client(&server, client);
+        continue;
+      }
+      set_interest(&server, client);
+    }
+  }
+
+  close(server.epoll_fd);
+  close(server.listen_fd);
+  unlink(socket_path);
+}
+
+#else
+
+void serve_book(OrderBook *book, const char *socket_path, ServerIngest ingest,
+                ServerSync sync, void *ctx) {
+  (void)book;
+  (void)socket_path;
+  (void)ingest;
+  (void)sync;
+  (void)ctx;
+  fprintf(stderr, "Server mode needs epoll (Linux)\n");
+  exit(EXIT_FAILURE);
+}
+
+#endif
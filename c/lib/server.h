@@ -0,0 +1,30 @@
+// Server mode: a book fed over one Unix socket connection and queried
+// over others.
+//
+// Connections speak the text event format, one event per line. The
+// connection whose first line is INGEST is the event stream: its events
+// go to the ingest callback exactly as events from standard input would,
+// query output included. Every other connection may only send BIDS and
+// ASKS. Each is answered on the connection from the current book: the
+// header, the orders and a blank line, so an empty side is just the
+// header and the blank line. Anything else gets `ERR <reason>` and a
+// blank line.
+//
+// A single-threaded epoll loop serves all connections. Replies are
+// queued in per-client buffers and written without blocking, so a slow
+// client never holds up ingest; the server just stops reading requests
+// from a client while too much of its output is pending. The server
+// returns once the ingest connection has closed and no clients remain.
+
+#pragma once
+
+#include "events.h"
+#include "orderbook.h"
+
+typedef void (*ServerIngest)(const Event *event, void *ctx);
+// Called before a client's query is answered, so a caller that holds
+// back ingested events (--compact) can apply them first; may be NULL
+typedef void (*ServerSync)(void *ctx);
+
+void serve_book(OrderBook *book, const char *socket_path, ServerIngest ingest,
+                ServerSync sync, void *ctx);
@@ -0,0 +1,80 @@
+#include "slab_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+void init_slab_pool(SlabPool *pool, size_t object_size, size_t slab_objects) {
+  if (object_size < sizeof(void *))
+    object_size = sizeof(void *);
+  pool->object_size =
+      (object_size + SLAB_ALIGNMENT - 1) / SLAB_ALIGNMENT * SLAB_ALIGNMENT;
+  pool->slab_objects = slab_objects;
+  pool->slabs = NULL;
+  pool->free_list = NULL;
+  pool->slab_count = 0;
+  pool->live = 0;
+}
+
+void free_slab_pool(SlabPool *pool) {
+  Slab *slab = pool->slabs;
+  while (slab) {
+    Slab *next = slab->next;
+    free(slab->objects);
+    free(slab);
+    slab = next;
+  }
+  pool->slabs = NULL;
+  pool->free_list = NULL;
+  pool->slab_count = 0;
+  pool->live = 0;
+}
+
+static Slab *allocate_slab(const SlabPool *pool) {
+  Slab *slab = malloc(sizeof *slab);
+  if (!slab)
+    return NULL;
+
+  slab->objects =
+      aligned_alloc(SLAB_ALIGNMENT, pool->object_size * pool->slab_objects);
+  if (!slab->objects) {
+    free(slab);
+    return NULL;
+  }
+  slab->used = 0;
+  slab->next = NULL;
+  return slab;
+}
+
+void *slab_alloc(SlabPool *pool) {
+  pool->live++;
+
+  if (pool->free_list) {
+    void *object = pool->free_list;
+    pool->free_list = *(void **)object;
+    return object;
+  }
+
+  if (!pool->slabs || pool->slabs->used == pool->slab_objects) {
+    Slab *slab = allocate_slab(pool);
+    if (!slab) {
+      perror("Failed to allocate slab");
+      exit(EXIT_FAILURE);
+    }
+    slab->next = pool->slabs;
+    pool->slabs = slab;
+    pool->slab_count++;
+  }
+
+  return pool->slabs->objects + pool->object_size * pool->slabs->used++;
+}
+
+void slab_free(SlabPool *pool, void *object) {
+  *(void **)object = pool->free_list;
+  pool->free_list = object;
+  pool->live--;
+}
+
+void print_slab_stats(const SlabPool *pool, const char *label, FILE *out) {
+  fprintf(out, "%-13s  %zu slabs of %zu x %zu bytes, %zu live\n", label,
+          pool->slab_count, pool->slab_objects, pool->object_size,
+          pool->live);
+}
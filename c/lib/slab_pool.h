@@ -0,0 +1,36 @@
+// Fixed-size object allocation from cache-line aligned slabs.
+//
+// Objects are carved from slabs of slab_objects objects each and freed
+// objects are kept on a free list for reuse. Object sizes are rounded up
+// to a whole number of cache lines, so no object shares a line with its
+// neighbours. Memory goes back to the system only in free_slab_pool.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdio.h>
+
+#define SLAB_ALIGNMENT 64
+
+typedef struct Slab {
+  struct Slab *next;
+  char *objects;
+  size_t used; // objects handed out from this slab so far
+} Slab;
+
+typedef struct {
+  Slab *slabs;
+  void *free_list; // freed objects, linked through their first word
+  size_t object_size;
+  size_t slab_objects;
+
+  // Statistics
+  size_t slab_count;
+  size_t live; // objects handed out and not yet freed
+} SlabPool;
+
+void init_slab_pool(SlabPool *pool, size_t object_size, size_t slab_objects);
+void free_slab_pool(SlabPool *pool);
+void *slab_alloc(SlabPool *pool);
+void slab_free(SlabPool *pool, void *object);
+void print_slab_stats(const SlabPool *pool, const char *label, FILE *out);
@@ -0,0 +1,97 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "arena.h"
+#include "sorted_sides.h"
+
+// ---------- Initialization and Cleanup ----------
+
+void *init_sorted_sides(const SortedSideOps *ops) {
+  SortedSides *book = malloc(sizeof *book);
+  if (!book) {
+    perror("malloc sorted sides");
+    exit(1);
+  }
+  book->ops = ops;
+  for (int type = ORDER_BUY; type <= ORDER_SELL; type++) {
+    book->sides[type] = malloc(ops->side_size);
+    if (!book->sides[type]) {
+      perror("malloc sorted side");
+      exit(1);
+    }
+    ops->init(book->sides[type], (OrderType)type);
+    book->sizes[type] = 0;
+  }
+  id_index_init(&book->index, capacity_hint(1024));
+  init_order_pool(&book->pool, 1024); // Preallocate blocks of 1024 orders
+  return book;
+}
+
+void free_sorted_sides(void *impl) {
+  SortedSides *book = impl;
+  for (int type = ORDER_BUY; type <= ORDER_SELL; type++) {
+    book->ops->free(book->sides[type]);
+    free(book->sides[type]);
+  }
+  id_index_free(&book->index);
+  free_order_pool(&book->pool);
+  free(book);
+}
+
+// ---------- Event Handlers ----------
+
+void sorted_sides_create(void *impl, Order o) {
+  SortedSides *book = impl;
+  Order *order = allocate_order(&book->pool, o.order_id, o.order_type,
+                                o.price, o.quantity);
+  id_index_put(&book->index, order->order_id, order);
+  book->ops->insert(book->sides[order->order_type], order);
+  book->sizes[order->order_type]++;
+}
+
+void sorted_sides_update(void *impl, int order_id, int price) {
+  SortedSides *book = impl;
+  Order *order = id_index_get(&book->index, order_id);
+  if (!order)
+    return;
+  void *side = book->sides[order->order_type];
+  book->ops->remove(side, order);
+  order->price = price;
+  book->ops->insert(side, order);
+}
+
+void sorted_sides_remove(void *impl, int order_id) {
+  SortedSides *book = impl;
+  Order *order = id_index_remove(&book->index, order_id);
+  if (!order)
+    return;
+  book->ops->remove(book->sides[order->order_type], order);
+  book->sizes[order->order_type]--;
+  release_order(&book->pool, order);
+}
+
+void sorted_sides_prefetch(void *impl, int order_id, int stage) {
+  id_index_prefetch(&((SortedSides *)impl)->index, order_id, stage);
+}
+
+size_t sorted_sides_query(void *impl, OrderType type, ObVisitor visit,
+                          void *ctx) {
+  SortedSides *book = impl;
+  if (visit)
+    book->ops->visit(book->sides[type], visit, ctx);
+  return book->sizes[type];
+}
+
+// ---------- Statistics ----------
+
+void print_sorted_sides_stats(const void *impl, FILE *out) {
+  const SortedSides *book = impl;
+  const IdIndex *index = &book->index;
+  for (int type = ORDER_BUY; type <= ORDER_SELL; type++)
+    book->ops->print_stats(book->sides[type], book->ops->labels[type], out);
+  fprintf(out, "%-13s  %zu slots, load %.3f, tombstones %.3f\n",
+          "id index:", index->capacity,
+          (double)index->size / (double)index->capacity,
+          (double)index->tombstones / (double)index->capacity);
+  print_pool_stats(&book->pool, out);
+}
@@ -0,0 +1,53 @@
+// Engines that keep both sides sorted at all times behind one id index.
+//
+// The id index maps an order id to its pooled Order, which records the
+// side and the key to find it by, so the side container only ever sees
+// inserts and removals: an UPDATE is a removal and a reinsertion at the
+// new price. A query walks the side in order and never sorts.
+//
+// The container is described by a SortedSideOps table, and the book's
+// functions below fill in the engine's ObBackend. An engine only
+// provides the table and an init_book that passes it to
+// init_sorted_sides, as c/chunked_sorted and c/bplus_tree do.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "id_index.h"
+#include "order.h"
+#include "order_pool.h"
+#include "orderbook.h"
+
+typedef struct {
+  size_t side_size; // bytes of one side container
+  void (*init)(void *side, OrderType type);
+  void (*free)(void *side);
+  void (*insert)(void *side, const Order *order);
+  // The order is on this side with the price it was inserted with
+  void (*remove)(void *side, const Order *order);
+  // Visit the side's orders, best first
+  void (*visit)(const void *side, ObVisitor visit, void *ctx);
+  void (*print_stats)(const void *side, const char *label, FILE *out);
+  const char *labels[2]; // stats label per OrderType
+} SortedSideOps;
+
+typedef struct {
+  const SortedSideOps *ops;
+  void *sides[2];  // indexed by OrderType
+  size_t sizes[2]; // orders per side
+  IdIndex index;   // order_id → Order*, shared by both sides
+  OrderPool pool;
+} SortedSides;
+
+void *init_sorted_sides(const SortedSideOps *ops);
+void free_sorted_sides(void *impl);
+
+void sorted_sides_create(void *impl, Order order);
+void sorted_sides_update(void *impl, int order_id, int price);
+void sorted_sides_remove(void *impl, int order_id);
+size_t sorted_sides_query(void *impl, OrderType type, ObVisitor visit,
+                          void *ctx);
+void sorted_sides_prefetch(void *impl, int order_id, int stage);
+void print_sorted_sides_stats(const void *impl, FILE *out);
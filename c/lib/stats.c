@@ -0,0 +1,28 @@
+#include "arena.h"
+#include "async_io.h"
+#include "stats.h"
+#include "timing.h"
+
+_Thread_local EngineStats engine_stats;
+
+void print_engine_stats(FILE *out) {
+  const EngineStats *s = &engine_stats;
+  fprintf(out, "events:        %llu\n", (unsigned long long)s->events);
+  if (s->map_lookups) {
+    fprintf(out, "map probes:    %llu lookups, avg %.2f, max %llu\n",
+            (unsigned long long)s->map_lookups,
+            (double)s->map_probes / (double)s->map_lookups,
+            (unsigned long long)s->map_max_probe);
+    fprintf(out, "map resizes:   %llu in %.3f ms\n",
+            (unsigned long long)s->map_resizes,
+            ticks_to_ns(s->map_resize_ticks) / 1e6);
+  }
+  if (s->sorts) {
+    fprintf(out, "sorts:         %llu, %llu keys in %.3f ms\n",
+            (unsigned long long)s->sorts, (unsigned long long)s->keys_sorted,
+            ticks_to_ns(s->sort_ticks) / 1e6);
+  }
+  fprintf(out, "bytes written: %llu\n", (unsigned long long)s->bytes_written);
+  print_arena_stats(out);
+  print_async_io_stats(out);
+}
@@ -0,0 +1,44 @@
+// Engine internals counters.
+//
+// The counters are plain increments on a per-thread struct, cheap enough
+// to be collected unconditionally; --stats only controls whether they are
+// reported. Counters that belong to a single structure (tombstones in a
+// map, blocks in a pool) live in that structure instead.
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+typedef struct {
+  uint64_t events;
+
+  uint64_t map_lookups;
+  uint64_t map_probes; // slots inspected across all lookups
+  uint64_t map_max_probe;
+  uint64_t map_resizes;
+  uint64_t map_resize_ticks;
+
+  uint64_t sorts;
+  uint64_t keys_sorted;
+  uint64_t sort_ticks;
+
+  uint64_t bytes_written;
+} EngineStats;
+
+extern _Thread_local EngineStats engine_stats;
+
+static inline void count_probe(uint64_t probes) {
+  engine_stats.map_lookups++;
+  engine_stats.map_probes += probes;
+  if (probes > engine_stats.map_max_probe)
+    engine_stats.map_max_probe = probes;
+}
+
+static inline void count_sort(uint64_t keys, uint64_t ticks) {
+  engine_stats.sorts++;
+  engine_stats.keys_sorted += keys;
+  engine_stats.sort_ticks += ticks;
+}
+
+void print_engine_stats(FILE *out);
@@ -0,0 +1,29 @@
+#include "timing.h"
+
+static double ns_per_tick = 0.0;
+
+static uint64_t wall_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+void calibrate_ticks(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  uint64_t w0 = wall_ns();
+  uint64_t t0 = now_ticks();
+  while (wall_ns() - w0 < 10000000u)
+    ; // spin for 10ms
+  uint64_t t1 = now_ticks();
+  uint64_t w1 = wall_ns();
+  ns_per_tick = (double)(w1 - w0) / (double)(t1 - t0);
+#else
+  ns_per_tick = 1.0;
+#endif
+}
+
+double ticks_to_ns(uint64_t ticks) {
+  if (ns_per_tick == 0.0)
+    calibrate_ticks();
+  return (double)ticks * ns_per_tick;
+}
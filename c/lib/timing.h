@@ -0,0 +1,29 @@
+// Cheap monotonic timestamps for in-process measurements
+
+#pragma once
+
+#include <stdint.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// On x86 a tick is one time-stamp counter cycle; elsewhere it is a
+// nanosecond from CLOCK_MONOTONIC. Only differences are meaningful, and
+// they should go through ticks_to_ns() before being shown to anyone.
+static inline uint64_t now_ticks(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+// Measures the tick rate against the wall clock. Calling it is optional
+// (ticks_to_ns calibrates on first use) but it takes ~10ms, so drivers
+// call it up front rather than in the middle of a run.
+void calibrate_ticks(void);
+double ticks_to_ns(uint64_t ticks);
@@ -0,0 +1,109 @@
+#include "work_pool.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Jobs are coarse (whole input files), so a mutex per deque costs nothing
+// next to the work and keeps stealing simple
+typedef struct {
+  pthread_mutex_t lock;
+  size_t *jobs;
+  size_t front, back; // jobs[front .. back) are left
+} Deque;
+
+typedef struct {
+  Deque *deques;
+  unsigned threads;
+  WorkFn fn;
+  void *ctx;
+} Pool;
+
+typedef struct {
+  Pool *pool;
+  unsigned id;
+} Worker;
+
+static bool take_front(Deque *d, size_t *job) {
+  pthread_mutex_lock(&d->lock);
+  bool ok = d->front < d->back;
+  if (ok)
+    *job = d->jobs[d->front++];
+  pthread_mutex_unlock(&d->lock);
+  return ok;
+}
+
+static bool steal_back(Deque *d, size_t *job) {
+  pthread_mutex_lock(&d->lock);
+  bool ok = d->front < d->back;
+  if (ok)
+    *job = d->jobs[--d->back];
+  pthread_mutex_unlock(&d->lock);
+  return ok;
+}
+
+// Own jobs first, then the other deques in turn, starting after ours
+static bool next_job(Pool *pool, unsigned id, size_t *job) {
+  if (take_front(&pool->deques[id], job))
+    return true;
+  for (unsigned i = 1; i < pool->threads; i++)
+    if (steal_back(&pool->deques[(id + i) % pool->threads], job))
+      return true;
+  return false;
+}
+
+static void *work(void *arg) {
+  Worker *w = arg;
+  size_t job;
+  while (next_job(w->pool, w->id, &job))
+    w->pool->fn(job, w->id, w->pool->ctx);
+  return NULL;
+}
+
+void run_work_pool(size_t jobs, unsigned threads, WorkFn fn, void *ctx) {
+  if (threads == 0)
+    threads = 1;
+  if (threads > jobs)
+    threads = jobs ? (unsigned)jobs : 1;
+
+  Pool pool = {.threads = threads, .fn = fn, .ctx = ctx};
+  pool.deques = calloc(threads, sizeof *pool.deques);
+  size_t *slots = malloc((jobs ? jobs : 1) * sizeof *slots);
+  Worker *workers = malloc(threads * sizeof *workers);
+  pthread_t *tids = malloc(threads * sizeof *tids);
+  if (!pool.deques || !slots || !workers || !tids) {
+    perror("malloc work pool");
+    exit(EXIT_FAILURE);
+  }
+
+  // Deal the jobs: worker i gets jobs i, i + threads, ... in order
+  size_t next = 0;
+  for (unsigned i = 0; i < threads; i++) {
+    Deque *d = &pool.deques[i];
+    pthread_mutex_init(&d->lock, NULL);
+    d->jobs = slots + next;
+    for (size_t job = i; job < jobs; job += threads)
+      slots[next++] = job;
+    d->back = (size_t)(slots + next - d->jobs);
+  }
+
+  // The calling thread is worker 0
+  for (unsigned i = 0; i < threads; i++) {
+    workers[i] = (Worker){&pool, i};
+    if (i > 0 && pthread_create(&tids[i], NULL, work, &workers[i]) != 0) {
+      perror("pthread_create");
+      exit(EXIT_FAILURE);
+    }
+  }
+  work(&workers[0]);
+  for (unsigned i = 1; i < threads; i++)
+    pthread_join(tids[i], NULL);
+
+  for (unsigned i = 0; i < threads; i++)
+    pthread_mutex_destroy(&pool.deques[i].lock);
+  free(tids);
+  free(workers);
+  free(slots);
+  free(pool.deques);
+}
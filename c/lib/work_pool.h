@@ -0,0 +1,17 @@
+// A work-stealing thread pool for a fixed set of independent jobs.
+//
+// The jobs are dealt round-robin onto one deque per worker, in the order
+// given, so a caller that lists its biggest jobs first gets each worker
+// a similar share up front. A worker takes jobs from the front of its own
+// deque and, once that is empty, steals from the back of another's, where
+// the smallest of that worker's jobs are. No jobs are added while the
+// pool runs, so a worker that finds every deque empty is done.
+
+#pragma once
+
+#include <stddef.h>
+
+typedef void (*WorkFn)(size_t job, unsigned worker, void *ctx);
+
+// Run fn for jobs 0 .. jobs-1 on `threads` threads and wait for them all
+void run_work_pool(size_t jobs, unsigned threads, WorkFn fn, void *ctx);
@@ -0,0 +1,271 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+#include "driver.h"
+#include "indexed_book.h"
+#include "order.h"
+#include "order_pool.h"
+#include "orderbook.h"
+#include "packed_order.h"
+#include "radix_sort.h"
+
+// The radix engine on packed 64-bit orders. Each side is an unsorted
+// array of PackedOrder words, sorted on query by a radix sort over the
+// words themselves. Order ids are small and mostly dense, so the id
+// index is a plain array: slots[id] holds the order's slot in its side
+// and the side in the low bit, or SLOT_NONE for an id with no live order.
+// Ids can be skipped (--compact drops cancelled creates), so the array
+// grows to whatever id arrives.
+//
+// An order that does not fit the packed ranges switches the whole engine
+// to the wide layout of main.c (pooled Orders in an IndexedBook) for the
+// rest of the run.
+
+#define SLOT_NONE UINT32_MAX
+
+typedef struct {
+  PackedOrder *data;
+  size_t size;
+  size_t capacity;
+} PackedSide;
+
+typedef struct {
+  PackedSide sides[2]; // indexed by OrderType
+  uint32_t *slots;     // order id → slot << 1 | side, or SLOT_NONE
+  size_t slots_capacity;
+
+  bool wide; // switched to the wide layout below
+  IndexedBook book;
+  OrderPool pool;
+} Engine;
+
+// ---------- Initialization and Cleanup ----------
+
+static void *init_engine(void) {
+  Engine *engine = malloc(sizeof *engine);
+  if (!engine) {
+    perror("malloc packed engine");
+    exit(1);
+  }
+  for (int side = 0; side < 2; side++) {
+    engine->sides[side].size = 0;
+    engine->sides[side].capacity = capacity_hint(4);
+    engine->sides[side].data = arena_alloc(engine->sides[side].capacity *
+                                           sizeof *engine->sides[side].data);
+  }
+  engine->slots_capacity = capacity_hint(1024);
+  engine->slots = arena_alloc(engine->slots_capacity * sizeof *engine->slots);
+  memset(engine->slots, 0xff, engine->slots_capacity * sizeof *engine->slots);
+  engine->wide = false;
+  init_order_pool(&engine->pool, 1024); // Preallocate blocks of 1024 orders
+  return engine;
+}
+
+static void free_packed_layout(Engine *engine) {
+  for (int side = 0; side < 2; side++) {
+    arena_free(engine->sides[side].data);
+    engine->sides[side].data = NULL;
+    engine->sides[side].size = engine->sides[side].capacity = 0;
+  }
+  arena_free(engine->slots);
+  engine->slots = NULL;
+  engine->slots_capacity = 0;
+}
+
+static void free_engine(void *impl) {
+  Engine *engine = impl;
+  if (engine->wide)
+    free_indexed_book(&engine->book);
+  else
+    free_packed_layout(engine);
+  free_order_pool(&engine->pool);
+  free(engine);
+}
+
+// Move every packed order into pooled Orders in an IndexedBook
+static void switch_to_wide(Engine *engine) {
+  init_indexed_book(&engine->book);
+  for (int side = 0; side < 2; side++) {
+    const PackedSide *s = &engine->sides[side];
+    for (size_t i = 0; i < s->size; i++) {
+      Order o = unpack_order(s->data[i]);
+      add_book_order(&engine->book,
+                     allocate_order(&engine->pool, o.order_id, o.order_type,
+                                    o.price, o.quantity));
+    }
+  }
+  free_packed_layout(engine);
+  engine->wide = true;
+}
+
+// ---------- Packed Operations ----------
+
+// Room for order_id in slots, with the new entries set to SLOT_NONE
+static void grow_slots(Engine *engine, int order_id) {
+  size_t capacity = engine->slots_capacity;
+  if ((size_t)order_id < capacity)
+    return;
+  while ((size_t)order_id >= capacity)
+    capacity *= 2;
+  engine->slots =
+      arena_grow(engine->slots, engine->slots_capacity * sizeof *engine->slots,
+                 capacity * sizeof *engine->slots);
+  memset(engine->slots + engine->slots_capacity, 0xff,
+         (capacity - engine->slots_capacity) * sizeof *engine->slots);
+  engine->slots_capacity = capacity;
+}
+
+static uint32_t slot_of(const Engine *engine, int order_id) {
+  return (size_t)order_id < engine->slots_capacity ? engine->slots[order_id]
+                                                   : SLOT_NONE;
+}
+
+static void set_slot(Engine *engine, int order_id, size_t slot,
+                     OrderType side) {
+  engine->slots[order_id] = (uint32_t)(slot << 1 | side);
+}
+
+static void append_packed(Engine *engine, PackedOrder w) {
+  OrderType side = packed_order_type(w);
+  PackedSide *s = &engine->sides[side];
+  if (s->size == s->capacity) {
+    s->capacity *= 2;
+    s->data = arena_grow(s->data, s->size * sizeof *s->data,
+                         s->capacity * sizeof *s->data);
+  }
+  set_slot(engine, packed_order_id(w), s->size, side);
+  s->data[s->size++] = w;
+}
+
+static void remove_packed(Engine *engine, uint32_t entry) {
+  PackedSide *s = &engine->sides[entry & 1];
+  size_t slot = entry >> 1;
+  engine->slots[packed_order_id(s->data[slot])] = SLOT_NONE;
+  PackedOrder last = s->data[--s->size];
+  if (slot < s->size) {
+    s->data[slot] = last;
+    set_slot(engine, packed_order_id(last), slot, packed_order_type(last));
+  }
+}
+
+// ---------- Event Handlers ----------
+
+static void handle_create(void *impl, Order o) {
+  Engine *engine = impl;
+  int order_id = o.order_id;
+
+  if (!engine->wide && !order_fits_packed(order_id, o.price, o.quantity))
+    switch_to_wide(engine);
+
+  if (engine->wide) {
+    add_book_order(&engine->book,
+                   allocate_order(&engine->pool, order_id, o.order_type,
+                                  o.price, o.quantity));
+    return;
+  }
+
+  grow_slots(engine, order_id);
+  append_packed(engine,
+                pack_order(order_id, o.order_type, o.price, o.quantity));
+}
+
+static void handle_update(void *impl, int order_id, int price) {
+  Engine *engine = impl;
+  if (!engine->wide) {
+    uint32_t entry = slot_of(engine, order_id);
+    if (entry == SLOT_NONE)
+      return;
+    PackedOrder *w = &engine->sides[entry & 1].data[entry >> 1];
+    Order o = unpack_order(*w);
+    if (order_fits_packed(o.order_id, price, o.quantity)) {
+      *w = pack_order(o.order_id, o.order_type, price, o.quantity);
+      return;
+    }
+    switch_to_wide(engine);
+  }
+
+  Order *order = find_book_order(&engine->book, order_id);
+  if (order)
+    order->price = price;
+}
+
+static void handle_remove(void *impl, int order_id) {
+  Engine *engine = impl;
+  if (!engine->wide) {
+    uint32_t entry = slot_of(engine, order_id);
+    if (entry != SLOT_NONE)
+      remove_packed(engine, entry);
+    return;
+  }
+
+  Order *order = remove_book_order(&engine->book, order_id);
+  if (order)
+    release_order(&engine->pool, order);
+}
+
+// Packed orders are unpacked one at a time for the visitor
+static size_t handle_query(void *impl, OrderType side, ObVisitor visit,
+                           void *ctx) {
+  Engine *engine = impl;
+  if (engine->wide) {
+    BookSide *orders =
+        side == ORDER_BUY ? &engine->book.buys : &engine->book.sells;
+    if (orders->size == 0)
+      return 0;
+    sort_book_side(&engine->book, orders,
+                   side == ORDER_BUY ? sort_bids_range : sort_asks_range);
+    if (visit)
+      for (size_t i = 0; i < orders->size; i++)
+        visit(orders->data[i], ctx);
+    return orders->size;
+  }
+
+  PackedSide *s = &engine->sides[side];
+  if (s->size == 0)
+    return 0;
+  sort_packed_orders(s->data, s->size);
+  for (size_t i = 0; i < s->size; i++)
+    set_slot(engine, packed_order_id(s->data[i]), i, side);
+  if (visit) {
+    for (size_t i = 0; i < s->size; i++) {
+      Order order = unpack_order(s->data[i]);
+      visit(&order, ctx);
+    }
+  }
+  return s->size;
+}
+
+// ---------- Statistics ----------
+
+static void print_stats(const void *impl, FILE *out) {
+  const Engine *engine = impl;
+  if (engine->wide) {
+    fprintf(out, "layout:        wide\n");
+    print_book_stats(&engine->book, out);
+  } else {
+    fprintf(out, "layout:        packed, %zu buys, %zu sells, %zu id slots\n",
+            engine->sides[ORDER_BUY].size, engine->sides[ORDER_SELL].size,
+            engine->slots_capacity);
+  }
+  print_pool_stats(&engine->pool, out);
+}
+
+static const ObBackend packed_backend = {
+    .name = "packed",
+    .init_book = init_engine,
+    .free_book = free_engine,
+    .create = handle_create,
+    .update = handle_update,
+    .remove = handle_remove,
+    .query = handle_query,
+    .print_stats = print_stats,
+};
+
+// ---------- Main ----------
+
+int main(int argc, char *argv[]) {
+  return run_driver(argc, argv, &packed_backend);
+}
@@ -2,10 +2,12 @@
 #include <stdlib.h>
 #include <string.h>
 
-#include "args.h"
-#include "events.h"
+#include "driver.h"
 #include "order.h"
 #include "order_array.h"
+#include "orderbook.h"
+#include "stats.h"
+#include "timing.h"
 
 // Sort helpers
 
@@ -26,117 +28,90 @@ static int cmp_order_desc(const void *a, const void *b) {
 }
 
 static void sort_orders_ascending(OrderArray *orders) {
+  uint64_t start = now_ticks();
   qsort(orders->data, orders->size, sizeof(Order), cmp_order_asc);
+  count_sort(orders->size, now_ticks() - start);
 }
 
 static void sort_orders_descending(OrderArray *orders) {
+  uint64_t start = now_ticks();
   qsort(orders->data, orders->size, sizeof(Order), cmp_order_desc);
+  count_sort(orders->size, now_ticks() - start);
 }
 
-// Print and creation
+// Book
 
-static void print_orders(const OrderArray *orders) {
-  for (size_t i = 0; i < orders->size; i++) {
-    printf("\t");
-    print_order(order_at_index(orders, i));
+typedef struct {
+  OrderArray sides[2]; // indexed by OrderType
+} UnsortedLists;
+
+static void *init_lists(void) {
+  UnsortedLists *lists = malloc(sizeof *lists);
+  if (!lists) {
+    perror("malloc unsorted lists");
+    exit(1);
   }
+  init_order_array(&lists->sides[ORDER_BUY]);
+  init_order_array(&lists->sides[ORDER_SELL]);
+  return lists;
 }
 
-static void create_order(OrderArray *orders, int order_id,
-                         const CreateOrder *co) {
-  Order order =
-      make_order(order_id, co->side == SIDE_BUY ? ORDER_BUY : ORDER_SELL,
-                 co->price, co->quantity);
-  append_order(orders, order);
+static void free_lists(void *impl) {
+  UnsortedLists *lists = impl;
+  free_order_array(&lists->sides[ORDER_BUY]);
+  free_order_array(&lists->sides[ORDER_SELL]);
+  free(lists);
 }
 
 // Event handling
 
-static void handle_create(OrderArray *buys, OrderArray *sells,
-                          const CreateOrder *co, int *order_id) {
-  if (co->side == SIDE_BUY) {
-    create_order(buys, (*order_id)++, co);
-  } else {
-    create_order(sells, (*order_id)++, co);
-  }
+static void create_in_lists(void *impl, Order order) {
+  UnsortedLists *lists = impl;
+  append_order(&lists->sides[order.order_type], order);
 }
 
-static void handle_update(OrderArray *buys, OrderArray *sells,
-                          const UpdateOrder *uo) {
-  Order *order = order_by_id(buys, uo->order_id);
+static void update_in_lists(void *impl, int order_id, int price) {
+  UnsortedLists *lists = impl;
+  Order *order = order_by_id(&lists->sides[ORDER_BUY], order_id);
   if (!order)
-    order = order_by_id(sells, uo->order_id);
+    order = order_by_id(&lists->sides[ORDER_SELL], order_id);
   if (order)
-    order->price = uo->price;
+    order->price = price;
 }
 
-static void handle_remove(OrderArray *buys, OrderArray *sells, int order_id) {
-  remove_by_id(buys, order_id);
-  remove_by_id(sells, order_id);
+static void remove_from_lists(void *impl, int order_id) {
+  UnsortedLists *lists = impl;
+  remove_by_id(&lists->sides[ORDER_BUY], order_id);
+  remove_by_id(&lists->sides[ORDER_SELL], order_id);
 }
 
-static void handle_bids(OrderArray *buys, bool silent) {
-  if (buys->size == 0)
-    return;
-  sort_orders_descending(buys);
-  if (!silent) {
-    printf("Bids\n");
-    print_orders(buys);
-    printf("\n");
-  }
+static size_t query_lists(void *impl, OrderType side, ObVisitor visit,
+                          void *ctx) {
+  OrderArray *orders = &((UnsortedLists *)impl)->sides[side];
+  if (orders->size == 0)
+    return 0;
+  if (side == ORDER_BUY)
+    sort_orders_descending(orders);
+  else
+    sort_orders_ascending(orders);
+  if (visit)
+    for (size_t i = 0; i < orders->size; i++)
+      visit(&orders->data[i], ctx);
+  return orders->size;
 }
 
-static void handle_asks(OrderArray *sells, bool silent) {
-  if (sells->size == 0)
-    return;
-  sort_orders_ascending(sells);
-  if (!silent) {
-    printf("Asks\n");
-    print_orders(sells);
-    printf("\n");
-  }
-}
+static const ObBackend unsorted_lists_backend = {
+    .name = "unsorted_lists",
+    .init_book = init_lists,
+    .free_book = free_lists,
+    .create = create_in_lists,
+    .update = update_in_lists,
+    .remove = remove_from_lists,
+    .query = query_lists,
+};
 
 // Main
 
 int main(int argc, char *argv[]) {
-  Config cfg;
-  parse_args(&cfg, argc, argv);
-  if (cfg.input_file) {
-    freopen(cfg.input_file, "r", stdin);
-  }
-
-  OrderArray buys, sells;
-  init_order_array(&buys);
-  init_order_array(&sells);
-
-  EventIterator it;
-  event_iterator_init(&it, stdin);
-
-  int order_id_counter = 0;
-  Event event;
-  while (event_iterator_next(&it, &event)) {
-    switch (event.type) {
-    case EVENT_CREATE:
-      handle_create(&buys, &sells, &event.data.create, &order_id_counter);
-      break;
-    case EVENT_UPDATE:
-      handle_update(&buys, &sells, &event.data.update);
-      break;
-    case EVENT_REMOVE:
-      handle_remove(&buys, &sells, event.data.remove.order_id);
-      break;
-    case EVENT_BIDS:
-      handle_bids(&buys, cfg.silent);
-      break;
-    case EVENT_ASKS:
-      handle_asks(&sells, cfg.silent);
-      break;
-    }
-  }
-
-  event_iterator_close(&it);
-  free_order_array(&buys);
-  free_order_array(&sells);
-  return 0;
-}
\ No newline at end of file
+  return run_driver(argc, argv, &unsorted_lists_backend);
+}
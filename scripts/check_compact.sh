@@ -0,0 +1,60 @@
+#!/bin/zsh
+
+# Regression check for --compact on the C engines.
+#
+# A CREATE that is removed again before the next query is cancelled and
+# its id skipped, so long runs of cancelled creates leave gaps in the ids
+# the book sees. Each engine must give the same output with --compact as
+# without it, on inputs with such gaps, with sparse queries and with no
+# queries at all.
+#
+#   make && scripts/check_compact.sh
+
+script_dir="$(cd "$(dirname "$0")" && pwd)"
+cd "$script_dir/.." || exit 1
+
+tempdir=$(mktemp -d)
+trap 'rm -rf "$tempdir"' EXIT
+
+# 5000 orders created and removed with no query in between, then one
+# order that lands far past the ids the book has seen
+{
+  for i in $(seq 0 4999); do echo "CREATE Buy $((100 + i % 50)) 10"; done
+  for i in $(seq 0 4999); do echo "REMOVE $i"; done
+  echo "CREATE Sell 120 7"
+  echo "CREATE Buy 101 20"
+  echo "BIDS"
+  echo "ASKS"
+  echo "UPDATE 5001 99"
+  echo "REMOVE 5000"
+  echo "BIDS"
+  echo "ASKS"
+} > "$tempdir/cancelled.txt"
+
+simulator/simulate -n 300000 --seed 3 -p market-hours --query-weight 0 \
+  -o "$tempdir/no_queries.txt" || exit 1
+simulator/simulate -n 100000 --seed 3 -p market-hours --query-weight 1 \
+  -o "$tempdir/sparse_queries.txt" || exit 1
+
+failed=0
+for engine in c/unsorted_lists/main c/sorted_lists/main \
+  c/unsorted_id_hash/main c/radix_sorted_on_query/main \
+  c/radix_sorted_on_query/bytes c/radix_sorted_on_query/packed \
+  c/chunked_sorted/main c/bplus_tree/main; do
+  for input in cancelled no_queries sparse_queries; do
+    events="$tempdir/$input.txt"
+    if ! "$engine" -i "$events" > "$tempdir/expected.txt"; then
+      echo "FAIL $engine $input: failed without --compact"
+      failed=1
+    elif ! "$engine" --compact -i "$events" > "$tempdir/compact.txt"; then
+      echo "FAIL $engine --compact $input: failed"
+      failed=1
+    elif ! cmp -s "$tempdir/expected.txt" "$tempdir/compact.txt"; then
+      echo "FAIL $engine --compact $input: output differs"
+      failed=1
+    else
+      echo "ok   $engine --compact $input"
+    fi
+  done
+done
+exit $failed
@@ -25,6 +25,9 @@ medium=(
   c_unsorted_id_hash
   c_radix_on_query
   c_radix_on_query_bytes
+  c_radix_on_query_packed
+  c_chunked_sorted
+  c_bplus_tree
   py_sorted_list
   rust_sorted
   rust_blocks
@@ -33,12 +36,16 @@ medium=(
 )
 large=(
   c_sorted
+  c_chunked_sorted
+  c_bplus_tree
   rust_sorted
   rust_blocks
   rust_blocks_and_table
   rust_btree
 )
 huge=(
+  c_chunked_sorted
+  c_bplus_tree
   rust_blocks_and_table
   rust_btree
 )
@@ -50,6 +57,7 @@ run_huge=false;   plot_huge=false;   plot_huge_explicit=false
 
 verbose=false
 list_only=false
+gen_args=()
 
 small_csv="small.csv";   small_start=1000;    small_end=10000;    small_step=500
 medium_csv="medium.csv"; medium_start=20000;  medium_end=200000;  medium_step=10000
@@ -97,6 +105,9 @@ while [[ $# -gt 0 ]]; do
     --large-list)   large=( $(split_csv_to_array $2) );  shift 2;;
     --huge-list)    huge=( $(split_csv_to_array $2) );   shift 2;;
 
+    --seed)         gen_args+=(--seed $2);    shift 2;;
+    --profile)      gen_args+=(--profile $2); shift 2;;
+
     --verbose)      verbose=true;    shift;;
     --no-verbose)   verbose=false;   shift;;
 
@@ -136,6 +147,10 @@ Options:
   --large-list <csv>    comma-separated tools for large
   --huge-list <csv>     comma-separated tools for huge
 
+  --seed <n>            seed the workload generator for reproducible runs
+  --profile <name>      workload profile: uniform (default), market-hours,
+                        deep-book or query-heavy
+
   --verbose             show per-tool timing (default: progress bars)
   --no-verbose          hide per-tool timing (show progress bars)
 
@@ -239,7 +254,7 @@ run_generic() {
   local count=0
 
   for N in "${Ns[@]}"; do
-    python3 simulator/simulate.py -n "$N" -o "$test_data"
+    simulator/simulate -n "$N" -o "$test_data" "${gen_args[@]}"
 
     # launch each tool measurement in the background
     tmpjobs=()
@@ -15,8 +15,18 @@ tools=(
   c_unsorted_id_hash       "c/unsorted_id_hash/main"
   c_radix_on_query         "c/radix_sorted_on_query/main"
   c_radix_on_query_bytes   "c/radix_sorted_on_query/bytes"
+  c_radix_on_query_packed  "c/radix_sorted_on_query/packed"
+  c_chunked_sorted         "c/chunked_sorted/main"
+  c_bplus_tree             "c/bplus_tree/main"
   rust_sorted              "rust/target/release/sorted"
   rust_blocks              "rust/target/release/blocks"
   rust_blocks_and_table    "rust/target/release/blocks_and_table"
   rust_btree               "rust/target/release/btree"
 )
+
+# Profile-guided builds (make BUILD=pgo) sit next to the release binaries;
+# time them too when they have been built.
+for name in ${(k)tools}; do
+  [[ ${tools[$name]} == c/* && -x "${tools[$name]}.pgo" ]] &&
+    tools[${name}_pgo]="${tools[$name]}.pgo"
+done
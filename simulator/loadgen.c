@@ -0,0 +1,262 @@
+// Load generator for engines in server mode (--listen).
+//
+//   loadgen --socket PATH [--clients N] [--queries N] [--ingest FILE]
+//
+// Opens N client connections (default 4) that each send N queries
+// (default 10000), alternating BIDS and ASKS, with one query outstanding
+// per connection. With --ingest it also streams FILE to the server as
+// the ingest connection while the queries run. At the end it reports
+// queries/s and the latency percentiles of the queries, from sending the
+// request to reading the last byte of the reply, on stderr.
+//
+// Everything runs in one thread around poll(), like the server.
+
+#include <errno.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef struct {
+  int fd;
+  long sent;       // queries sent
+  bool waiting;    // for the reply to the last one
+  char last;       // last byte of the reply so far
+  uint64_t started; // when the outstanding query was sent
+} QueryClient;
+
+typedef struct {
+  int fd;
+  FILE *file;
+  char buf[64 * 1024];
+  size_t start, end;
+  bool done;
+} Ingest;
+
+typedef struct {
+  uint64_t *data;
+  size_t size, capacity;
+} Samples;
+
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void add_sample(Samples *s, uint64_t ns) {
+  if (s->size == s->capacity) {
+    s->capacity = s->capacity ? s->capacity * 2 : 1024;
+    s->data = realloc(s->data, s->capacity * sizeof *s->data);
+    if (!s->data) {
+      perror("realloc samples");
+      exit(EXIT_FAILURE);
+    }
+  }
+  s->data[s->size++] = ns;
+}
+
+static int cmp_u64(const void *a, const void *b) {
+  uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+  return (x > y) - (x < y);
+}
+
+static int connect_to(const char *path) {
+  struct sockaddr_un addr = {.sun_family = AF_UNIX};
+  if (strlen(path) >= sizeof addr.sun_path) {
+    fprintf(stderr, "Socket path too long: %s\n", path);
+    exit(EXIT_FAILURE);
+  }
+  strcpy(addr.sun_path, path);
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof addr) != 0) {
+    perror(path);
+    exit(EXIT_FAILURE);
+  }
+  return fd;
+}
+
+static void write_all(int fd, const char *data, size_t len) {
+  while (len > 0) {
+    ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      perror("send");
+      exit(EXIT_FAILURE);
+    }
+    data += n;
+    len -= (size_t)n;
+  }
+}
+
+static void send_query(QueryClient *c) {
+  const char *query = c->sent % 2 == 0 ? "BIDS\n" : "ASKS\n";
+  c->started = now_ns();
+  write_all(c->fd, query, 5);
+  c->sent++;
+  c->waiting = true;
+  c->last = '\0';
+}
+
+// Read what has arrived of the reply. A reply ends with a blank line, the
+// only place two newlines meet. True when it is complete.
+static bool read_reply(QueryClient *c) {
+  char buf[64 * 1024];
+  ssize_t n = recv(c->fd, buf, sizeof buf, MSG_DONTWAIT);
+  if (n == 0) {
+    fprintf(stderr, "Server closed the connection\n");
+    exit(EXIT_FAILURE);
+  }
+  if (n < 0) {
+    if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+      return false;
+    perror("recv");
+    exit(EXIT_FAILURE);
+  }
+  // One query is outstanding, so the reply ends the data
+  bool complete = (n >= 2 && buf[n - 2] == '\n' && buf[n - 1] == '\n') ||
+                  (n == 1 && c->last == '\n' && buf[0] == '\n');
+  c->last = buf[n - 1];
+  return complete;
+}
+
+// Push the next chunk of the ingest file without blocking
+static void feed_ingest(Ingest *in) {
+  if (in->start == in->end) {
+    in->start = 0;
+    in->end = fread(in->buf, 1, sizeof in->buf, in->file);
+    if (in->end == 0) {
+      close(in->fd);
+      in->done = true;
+      return;
+    }
+  }
+  ssize_t n = send(in->fd, in->buf + in->start, in->end - in->start,
+                   MSG_DONTWAIT | MSG_NOSIGNAL);
+  if (n < 0) {
+    if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+      return;
+    perror("send ingest");
+    exit(EXIT_FAILURE);
+  }
+  in->start += (size_t)n;
+}
+
+static void usage(const char *prog) {
+  fprintf(stderr,
+          "Usage: %s --socket PATH [--clients N] [--queries N] "
+          "[--ingest FILE]\n",
+          prog);
+  exit(EXIT_FAILURE);
+}
+
+int main(int argc, char *argv[]) {
+  const char *path = NULL;
+  const char *ingest_file = NULL;
+  long clients = 4;
+  long queries = 10000;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--socket") == 0 && i + 1 < argc)
+      path = argv[++i];
+    else if (strcmp(argv[i], "--clients") == 0 && i + 1 < argc)
+      clients = atol(argv[++i]);
+    else if (strcmp(argv[i], "--queries") == 0 && i + 1 < argc)
+      queries = atol(argv[++i]);
+    else if (strcmp(argv[i], "--ingest") == 0 && i + 1 < argc)
+      ingest_file = argv[++i];
+    else
+      usage(argv[0]);
+  }
+  if (!path || clients <= 0 || queries <= 0)
+    usage(argv[0]);
+
+  Ingest ingest = {.fd = -1, .done = true};
+  if (ingest_file) {
+    ingest.file = fopen(ingest_file, "r");
+    if (!ingest.file) {
+      perror(ingest_file);
+      return EXIT_FAILURE;
+    }
+    ingest.fd = connect_to(path);
+    write_all(ingest.fd, "INGEST\n", 7);
+    ingest.done = false;
+  }
+
+  QueryClient *cs = calloc((size_t)clients, sizeof *cs);
+  struct pollfd *fds = calloc((size_t)clients + 1, sizeof *fds);
+  if (!cs || !fds) {
+    perror("calloc");
+    return EXIT_FAILURE;
+  }
+  for (long i = 0; i < clients; i++)
+    cs[i].fd = connect_to(path);
+
+  Samples samples = {0};
+  uint64_t start = now_ns();
+  for (long i = 0; i < clients; i++)
+    send_query(&cs[i]);
+  long active = clients;
+
+  while (active > 0 || !ingest.done) {
+    nfds_t n = 0;
+    for (long i = 0; i < clients; i++)
+      if (cs[i].waiting)
+        fds[n++] = (struct pollfd){.fd = cs[i].fd, .events = POLLIN};
+    if (!ingest.done)
+      fds[n++] = (struct pollfd){.fd = ingest.fd, .events = POLLOUT};
+    if (poll(fds, n, -1) < 0) {
+      if (errno == EINTR)
+        continue;
+      perror("poll");
+      return EXIT_FAILURE;
+    }
+
+    nfds_t k = 0;
+    for (long i = 0; i < clients; i++) {
+      if (!cs[i].waiting)
+        continue;
+      if ((fds[k++].revents & (POLLIN | POLLHUP | POLLERR)) &&
+          read_reply(&cs[i])) {
+        add_sample(&samples, now_ns() - cs[i].started);
+        cs[i].waiting = false;
+        if (cs[i].sent < queries)
+          send_query(&cs[i]);
+        else
+          active--;
+      }
+    }
+    if (!ingest.done && (fds[k].revents & (POLLOUT | POLLERR)))
+      feed_ingest(&ingest);
+  }
+  double seconds = (double)(now_ns() - start) / 1e9;
+
+  for (long i = 0; i < clients; i++)
+    close(cs[i].fd);
+  if (ingest.file)
+    fclose(ingest.file);
+
+  qsort(samples.data, samples.size, sizeof *samples.data, cmp_u64);
+  const double pcts[] = {50, 90, 99, 99.9};
+  fprintf(stderr, "%zu queries over %ld clients in %.3f s: %.0f queries/s\n",
+          samples.size, clients, seconds, (double)samples.size / seconds);
+  fprintf(stderr, "latency (us):");
+  for (size_t i = 0; i < sizeof pcts / sizeof *pcts; i++) {
+    size_t idx = (size_t)(pcts[i] / 100.0 * (double)(samples.size - 1));
+    fprintf(stderr, " p%g %.1f", pcts[i], (double)samples.data[idx] / 1e3);
+  }
+  fprintf(stderr, " max %.1f\n",
+          (double)samples.data[samples.size - 1] / 1e3);
+
+  free(samples.data);
+  free(fds);
+  free(cs);
+  return 0;
+}
@@ -0,0 +1,81 @@
+"""Rebuild full query output from an engine's --delta output.
+
+Reads delta blocks on stdin and writes, for every block, the side it
+describes in full, exactly as the engine prints it without --delta. This
+is a reference for checking the delta mode, not a fast path:
+
+    c/radix_sorted_on_query/main --delta < events.txt \\
+        | python3 simulator/reconstruct.py | diff - expected.txt
+"""
+
+import argparse
+import sys
+from collections import Counter
+
+SIDES = {"Bids": "Buy", "Asks": "Sell"}
+
+
+def apply_line(book: Counter, line: str) -> None:
+    """Apply one `+`, `-` or `~` entry to a side's (price, quantity) counts."""
+    mark, _side, price, *quantities = line.split()
+    price = int(price)
+    if mark == "+":
+        book[(price, int(quantities[0]))] += 1
+    elif mark == "-":
+        book[(price, int(quantities[0]))] -= 1
+    elif mark == "~":
+        book[(price, int(quantities[0]))] -= 1
+        book[(price, int(quantities[1]))] += 1
+    else:
+        raise ValueError(f"Unknown delta entry: {line!r}")
+
+
+def snapshot(header: str, book: Counter) -> str:
+    """The side in full: best price first, quantity breaking ties the same way."""
+    orders = sorted(book.elements(), reverse=header == "Bids")
+    if not orders:
+        return ""
+    side = SIDES[header]
+    lines = "".join(f"\t{side} {price} {quantity}\n" for price, quantity in orders)
+    return f"{header}\n{lines}\n"
+
+
+def reconstruct(lines, out) -> None:
+    books = {header: Counter() for header in SIDES}
+    header = None
+    for line in lines:
+        line = line.rstrip("\n")
+        if header is None:
+            if line not in books:
+                raise ValueError(f"Expected Bids or Asks, got {line!r}")
+            header = line
+        elif line:
+            apply_line(books[header], line)
+        else:
+            if any(count < 0 for count in books[header].values()):
+                raise ValueError(f"{header} block removes a missing entry")
+            books[header] = +books[header]  # drop entries that went to zero
+            out.write(snapshot(header, books[header]))
+            header = None
+    if header is not None:
+        raise ValueError(f"Unterminated {header} block")
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Rebuilds full query output from --delta output.",
+    )
+    parser.add_argument(
+        "input",
+        type=argparse.FileType("r"),
+        metavar="FILE",
+        nargs="?",
+        default="-",
+        help="delta output to read (default: stdin)",
+    )
+    args = parser.parse_args()
+    reconstruct(args.input, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
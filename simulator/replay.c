@@ -0,0 +1,71 @@
+// Replay an event file into a shared-memory event ring.
+//
+//   replay --shm NAME [--binary|-b] [--capacity N] [FILE]
+//
+// Reads text events (or BinaryEvent records with --binary) from FILE or
+// stdin and pushes them into the ring NAME as fast as the consumer takes
+// them, for an engine started with --shm NAME. The engine can be started
+// before or after the replay. The ring holds --capacity records (default
+// 65536); the replay blocks while it is full.
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "event_ring.h"
+#include "events.h"
+
+static void usage(const char *prog) {
+  fprintf(stderr,
+          "Usage: %s --shm NAME [--binary|-b] [--capacity N] [FILE]\n",
+          prog);
+  exit(EXIT_FAILURE);
+}
+
+int main(int argc, char *argv[]) {
+  const char *name = NULL;
+  const char *input = NULL;
+  bool binary = false;
+  long capacity = 65536;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--shm") == 0 && i + 1 < argc) {
+      name = argv[++i];
+    } else if (strcmp(argv[i], "--binary") == 0 ||
+               strcmp(argv[i], "-b") == 0) {
+      binary = true;
+    } else if (strcmp(argv[i], "--capacity") == 0 && i + 1 < argc) {
+      capacity = atol(argv[++i]);
+    } else if (argv[i][0] != '-' && !input) {
+      input = argv[i];
+    } else {
+      usage(argv[0]);
+    }
+  }
+  if (!name || capacity <= 0)
+    usage(argv[0]);
+
+  FILE *file = input ? fopen(input, binary ? "rb" : "r") : stdin;
+  if (!file) {
+    perror(input);
+    return EXIT_FAILURE;
+  }
+  EventIterator iter;
+  event_iterator_init(&iter, file);
+  event_iterator_set_binary(&iter, binary);
+
+  EventRing ring;
+  event_ring_create(&ring, name, (size_t)capacity);
+
+  Event event;
+  while (event_iterator_next(&iter, &event)) {
+    BinaryEvent rec = encode_binary_event(&event);
+    event_ring_push(&ring, &rec);
+  }
+  event_ring_finish(&ring);
+
+  event_ring_close(&ring);
+  event_iterator_close(&iter);
+  return 0;
+}
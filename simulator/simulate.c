@@ -0,0 +1,437 @@
+// Native workload generator.
+//
+// Writes the same event stream as simulate.py, only much faster: given the
+// same --seed and --profile the text output is byte-for-byte identical,
+// because the generator reproduces CPython's Mersenne Twister seeding and
+// the way random.randint, random.randrange and random.choice draw from it.
+// With --binary it writes BinaryEvent records (see c/lib/events.h) instead
+// of text.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "events.h"
+
+// ---------- Mersenne Twister (MT19937) ----------
+
+#define MT_N 624
+#define MT_M 397
+
+typedef struct {
+  uint32_t state[MT_N];
+  int index;
+} Rng;
+
+static void rng_init_genrand(Rng *rng, uint32_t s) {
+  rng->state[0] = s;
+  for (int i = 1; i < MT_N; i++) {
+    uint32_t prev = rng->state[i - 1];
+    rng->state[i] = 1812433253u * (prev ^ (prev >> 30)) + (uint32_t)i;
+  }
+  rng->index = MT_N;
+}
+
+static void rng_init_by_array(Rng *rng, const uint32_t *key, size_t len) {
+  rng_init_genrand(rng, 19650218u);
+  uint32_t *mt = rng->state;
+  size_t i = 1, j = 0;
+  for (size_t k = MT_N > len ? MT_N : len; k; k--) {
+    mt[i] = (mt[i] ^ ((mt[i - 1] ^ (mt[i - 1] >> 30)) * 1664525u)) + key[j] +
+            (uint32_t)j;
+    i++;
+    j++;
+    if (i >= MT_N) {
+      mt[0] = mt[MT_N - 1];
+      i = 1;
+    }
+    if (j >= len)
+      j = 0;
+  }
+  for (size_t k = MT_N - 1; k; k--) {
+    mt[i] = (mt[i] ^ ((mt[i - 1] ^ (mt[i - 1] >> 30)) * 1566083941u)) -
+            (uint32_t)i;
+    i++;
+    if (i >= MT_N) {
+      mt[0] = mt[MT_N - 1];
+      i = 1;
+    }
+  }
+  mt[0] = 0x80000000u;
+}
+
+static void rng_twist(Rng *rng) {
+  uint32_t *mt = rng->state;
+  for (int i = 0; i < MT_N; i++) {
+    uint32_t y = (mt[i] & 0x80000000u) | (mt[(i + 1) % MT_N] & 0x7fffffffu);
+    mt[i] = mt[(i + MT_M) % MT_N] ^ (y >> 1) ^ ((y & 1u) ? 0x9908b0dfu : 0u);
+  }
+  rng->index = 0;
+}
+
+static inline uint32_t rng_next(Rng *rng) {
+  if (rng->index >= MT_N)
+    rng_twist(rng);
+  uint32_t y = rng->state[rng->index++];
+  y ^= y >> 11;
+  y ^= (y << 7) & 0x9d2c5680u;
+  y ^= (y << 15) & 0xefc60000u;
+  y ^= y >> 18;
+  return y;
+}
+
+// random.seed(n) for a non-negative int n: the key is n split into 32-bit
+// words, least significant first.
+static void rng_seed(Rng *rng, uint64_t seed) {
+  uint32_t key[2] = {(uint32_t)seed, (uint32_t)(seed >> 32)};
+  rng_init_by_array(rng, key, key[1] ? 2 : 1);
+}
+
+// random._randbelow(n): rejection sampling on n.bit_length() random bits.
+// random.randint(a, b) is a + rng_below(b - a + 1), random.randrange(n) is
+// rng_below(n) and random.choice(seq) is seq[rng_below(len(seq))].
+static inline uint32_t rng_below(Rng *rng, uint32_t n) {
+  int k = 32 - __builtin_clz(n);
+  uint32_t r;
+  do {
+    r = rng_next(rng) >> (32 - k);
+  } while (r >= n);
+  return r;
+}
+
+static inline int rng_int(Rng *rng, int lo, int hi) {
+  return lo + (int)rng_below(rng, (uint32_t)(hi - lo + 1));
+}
+
+// ---------- Profiles (mirrors PROFILES in simulate.py) ----------
+
+#define MAX_PRICE 10000
+
+typedef struct {
+  const char *name;
+  int weights[EVENT_ASKS + 1]; // indexed by EventType
+  bool clustered;
+  int spread;
+  int drift;
+  bool live_targets;
+} Profile;
+
+static const Profile profiles[] = {
+    {"uniform", {1, 1, 1, 1, 1}, false, 0, 0, false},
+    {"market-hours", {20, 50, 20, 5, 5}, true, 50, 2, true},
+    {"deep-book", {40, 40, 10, 5, 5}, true, 2000, 1, true},
+    {"query-heavy", {10, 10, 10, 35, 35}, true, 200, 2, true},
+};
+#define NUM_PROFILES (sizeof profiles / sizeof profiles[0])
+
+// ---------- Sampling (mirrors simulate.py) ----------
+
+typedef struct {
+  int largest_id;
+  Profile profile;
+  int total_weight;
+  int mid;
+
+  // Live orders, tracked only for profiles with live_targets
+  int *live;
+  size_t live_count;
+  int *position;     // order id -> index in live
+  OrderSide *sides;  // order id -> side
+  size_t id_capacity;
+} SimulatorState;
+
+static void *grow(void *ptr, size_t count, size_t elem) {
+  void *p = realloc(ptr, count * elem);
+  if (!p) {
+    perror("realloc");
+    exit(EXIT_FAILURE);
+  }
+  return p;
+}
+
+static void track_order(SimulatorState *state, int order_id, OrderSide side) {
+  if ((size_t)order_id >= state->id_capacity) {
+    state->id_capacity = state->id_capacity ? 2 * state->id_capacity : 1024;
+    state->live = grow(state->live, state->id_capacity, sizeof(int));
+    state->position = grow(state->position, state->id_capacity, sizeof(int));
+    state->sides = grow(state->sides, state->id_capacity, sizeof(OrderSide));
+  }
+  state->position[order_id] = (int)state->live_count;
+  state->live[state->live_count++] = order_id;
+  state->sides[order_id] = side;
+}
+
+static void forget_order(SimulatorState *state, int order_id) {
+  int i = state->position[order_id];
+  int last = state->live[--state->live_count];
+  if (last != order_id) {
+    state->live[i] = last;
+    state->position[last] = i;
+  }
+}
+
+static int sample_live_order(Rng *rng, SimulatorState *state) {
+  return state->live[rng_below(rng, (uint32_t)state->live_count)];
+}
+
+static int sample_price(Rng *rng) {
+  int sign = rng_below(rng, 2) ? 1 : -1;
+  return sign * rng_int(rng, 1, MAX_PRICE);
+}
+
+static int sample_clustered_price(Rng *rng, SimulatorState *state,
+                                  OrderSide side) {
+  const Profile *p = &state->profile;
+  state->mid += rng_int(rng, -p->drift, p->drift);
+  if (state->mid < -MAX_PRICE + p->spread)
+    state->mid = -MAX_PRICE + p->spread;
+  if (state->mid > MAX_PRICE - p->spread)
+    state->mid = MAX_PRICE - p->spread;
+  int a = rng_int(rng, 0, p->spread);
+  int b = rng_int(rng, 0, p->spread);
+  int offset = a < b ? a : b;
+  return side == SIDE_BUY ? state->mid - offset : state->mid + offset;
+}
+
+static int sample_order_price(Rng *rng, SimulatorState *state,
+                              OrderSide side) {
+  if (state->profile.clustered)
+    return sample_clustered_price(rng, state, side);
+  return sample_price(rng);
+}
+
+static EventType sample_event_type(Rng *rng, SimulatorState *state) {
+  int r = (int)rng_below(rng, (uint32_t)state->total_weight);
+  int type = EVENT_CREATE;
+  while (r >= state->profile.weights[type])
+    r -= state->profile.weights[type++];
+  // With live targets there is nothing to update or remove in an empty book
+  if (state->profile.live_targets && state->live_count == 0 &&
+      (type == EVENT_UPDATE || type == EVENT_REMOVE))
+    return EVENT_CREATE;
+  return (EventType)type;
+}
+
+static Event sample_event(Rng *rng, SimulatorState *state) {
+  Event event = {.type = sample_event_type(rng, state)};
+  int order_id;
+  switch (event.type) {
+  case EVENT_CREATE:
+    event.data.create.side = rng_below(rng, 2) ? SIDE_SELL : SIDE_BUY;
+    event.data.create.quantity = rng_int(rng, 1, 1000000);
+    event.data.create.price =
+        sample_order_price(rng, state, event.data.create.side);
+    if (state->profile.live_targets)
+      track_order(state, state->largest_id, event.data.create.side);
+    state->largest_id++;
+    break;
+  case EVENT_UPDATE:
+    if (state->profile.live_targets) {
+      order_id = sample_live_order(rng, state);
+      event.data.update.order_id = order_id;
+      event.data.update.price =
+          sample_order_price(rng, state, state->sides[order_id]);
+    } else {
+      event.data.update.order_id = rng_int(rng, 0, state->largest_id);
+      event.data.update.price = sample_price(rng);
+    }
+    break;
+  case EVENT_REMOVE:
+    if (state->profile.live_targets) {
+      order_id = sample_live_order(rng, state);
+      forget_order(state, order_id);
+      event.data.remove.order_id = order_id;
+    } else {
+      event.data.remove.order_id = rng_int(rng, 0, state->largest_id);
+    }
+    break;
+  case EVENT_BIDS:
+  case EVENT_ASKS:
+    break;
+  }
+  return event;
+}
+
+// ---------- Buffered Output ----------
+
+#define WRITE_BUF_SIZE (1 << 20)
+
+typedef struct {
+  FILE *file;
+  size_t used;
+  char buf[WRITE_BUF_SIZE];
+} Writer;
+
+static void writer_flush(Writer *w) {
+  if (w->used && fwrite(w->buf, 1, w->used, w->file) != w->used) {
+    perror("fwrite");
+    exit(EXIT_FAILURE);
+  }
+  w->used = 0;
+}
+
+static inline void put_str(Writer *w, const char *s, size_t len) {
+  memcpy(w->buf + w->used, s, len);
+  w->used += len;
+}
+
+static inline void put_int(Writer *w, int value) {
+  char tmp[12];
+  int n = 0;
+  unsigned int u = value < 0 ? 0u - (unsigned int)value : (unsigned int)value;
+  do {
+    tmp[n++] = (char)('0' + u % 10);
+    u /= 10;
+  } while (u);
+  if (value < 0)
+    w->buf[w->used++] = '-';
+  while (n)
+    w->buf[w->used++] = tmp[--n];
+}
+
+static void write_text_event(Writer *w, const Event *event) {
+  switch (event->type) {
+  case EVENT_CREATE:
+    put_str(w, "CREATE ", 7);
+    if (event->data.create.side == SIDE_BUY)
+      put_str(w, "Buy ", 4);
+    else
+      put_str(w, "Sell ", 5);
+    put_int(w, event->data.create.quantity);
+    w->buf[w->used++] = ' ';
+    put_int(w, event->data.create.price);
+    break;
+  case EVENT_UPDATE:
+    put_str(w, "UPDATE ", 7);
+    put_int(w, event->data.update.order_id);
+    w->buf[w->used++] = ' ';
+    put_int(w, event->data.update.price);
+    break;
+  case EVENT_REMOVE:
+    put_str(w, "REMOVE ", 7);
+    put_int(w, event->data.remove.order_id);
+    break;
+  case EVENT_BIDS:
+    put_str(w, "BIDS", 4);
+    break;
+  case EVENT_ASKS:
+    put_str(w, "ASKS", 4);
+    break;
+  }
+  w->buf[w->used++] = '\n';
+}
+
+static void write_binary_event(Writer *w, const Event *event) {
+  BinaryEvent rec = encode_binary_event(event);
+  put_str(w, (const char *)&rec, sizeof rec);
+}
+
+// ---------- Main ----------
+
+static void usage(const char *prog) {
+  fprintf(stderr,
+          "Usage: %s [-n|--num-updates N] [-o|--output FILE] [--seed S]\n"
+          "          [-p|--profile NAME] [--query-weight W] [--binary|-b]\n"
+          "Profiles:",
+          prog);
+  for (size_t i = 0; i < NUM_PROFILES; i++)
+    fprintf(stderr, " %s", profiles[i].name);
+  fprintf(stderr, "\n");
+  exit(EXIT_FAILURE);
+}
+
+static const Profile *find_profile(const char *name) {
+  for (size_t i = 0; i < NUM_PROFILES; i++)
+    if (strcmp(profiles[i].name, name) == 0)
+      return &profiles[i];
+  return NULL;
+}
+
+int main(int argc, char *argv[]) {
+  long num_updates = 10;
+  const char *output = NULL;
+  bool binary = false;
+  bool seeded = false;
+  uint64_t seed = 0;
+  const Profile *profile = &profiles[0];
+  int query_weight = -1;
+
+  for (int i = 1; i < argc; i++) {
+    if ((strcmp(argv[i], "-n") == 0 ||
+         strcmp(argv[i], "--num-updates") == 0) &&
+        i + 1 < argc) {
+      num_updates = atol(argv[++i]);
+    } else if ((strcmp(argv[i], "-o") == 0 ||
+                strcmp(argv[i], "--output") == 0) &&
+               i + 1 < argc) {
+      output = argv[++i];
+    } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+      seed = strtoull(argv[++i], NULL, 10);
+      seeded = true;
+    } else if ((strcmp(argv[i], "-p") == 0 ||
+                strcmp(argv[i], "--profile") == 0) &&
+               i + 1 < argc) {
+      profile = find_profile(argv[++i]);
+      if (!profile) {
+        fprintf(stderr, "Unknown profile: %s\n", argv[i]);
+        usage(argv[0]);
+      }
+    } else if (strcmp(argv[i], "--query-weight") == 0 && i + 1 < argc) {
+      query_weight = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--binary") == 0 ||
+               strcmp(argv[i], "-b") == 0) {
+      binary = true;
+    } else {
+      fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+      usage(argv[0]);
+    }
+  }
+
+  static Writer w;
+  w.file = (output && strcmp(output, "-") != 0) ? fopen(output, "wb") : stdout;
+  if (!w.file) {
+    perror(output);
+    exit(EXIT_FAILURE);
+  }
+
+  static Rng rng;
+  if (!seeded)
+    seed = (uint64_t)time(NULL) ^ ((uint64_t)getpid() << 32);
+  rng_seed(&rng, seed);
+
+  SimulatorState state = {.profile = *profile};
+  if (query_weight >= 0) {
+    state.profile.weights[EVENT_BIDS] = query_weight;
+    state.profile.weights[EVENT_ASKS] = query_weight;
+  }
+  for (int t = 0; t <= EVENT_ASKS; t++)
+    state.total_weight += state.profile.weights[t];
+  if (state.total_weight <= 0) {
+    fprintf(stderr, "The profile's event weights sum to zero\n");
+    exit(EXIT_FAILURE);
+  }
+
+  // Flush while there is still room for the longest text line
+  const size_t high_water = WRITE_BUF_SIZE - 64;
+  for (long i = 0; i < num_updates; i++) {
+    Event event = sample_event(&rng, &state);
+    if (binary)
+      write_binary_event(&w, &event);
+    else
+      write_text_event(&w, &event);
+    if (w.used >= high_water)
+      writer_flush(&w);
+  }
+  writer_flush(&w);
+
+  if (w.file != stdout)
+    fclose(w.file);
+  free(state.live);
+  free(state.position);
+  free(state.sides);
+  return 0;
+}
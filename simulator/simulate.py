@@ -1,6 +1,38 @@
 import argparse
 import random
-from dataclasses import dataclass
+from dataclasses import dataclass, field
+
+MAX_PRICE = 10000
+
+
+@dataclass
+class Profile:
+    """Workload profile: event mix, price model and update/remove targets."""
+
+    # Relative weights of CREATE, UPDATE, REMOVE, BIDS and ASKS.
+    weights: tuple[int, int, int, int, int]
+    # Prices cluster around a drifting mid instead of being uniform.
+    clustered: bool = False
+    # Largest distance from the mid (clustered prices only).
+    spread: int = 0
+    # Largest move of the mid per sampled price (clustered prices only).
+    drift: int = 0
+    # UPDATE and REMOVE pick a live order rather than any id ever created.
+    live_targets: bool = False
+
+
+PROFILES = {
+    "uniform": Profile((1, 1, 1, 1, 1)),
+    "market-hours": Profile(
+        (20, 50, 20, 5, 5), clustered=True, spread=50, drift=2, live_targets=True
+    ),
+    "deep-book": Profile(
+        (40, 40, 10, 5, 5), clustered=True, spread=2000, drift=1, live_targets=True
+    ),
+    "query-heavy": Profile(
+        (10, 10, 10, 35, 35), clustered=True, spread=200, drift=2, live_targets=True
+    ),
+}
 
 
 @dataclass
@@ -8,6 +40,12 @@ class SimulatorState:
     """State of the simulator."""
 
     largest_id: int = 0
+    profile: Profile = field(default_factory=lambda: PROFILES["uniform"])
+    mid: int = 0
+    # Live orders, tracked only for profiles with live_targets.
+    live: list[int] = field(default_factory=list)
+    position: dict[int, int] = field(default_factory=dict)
+    sides: dict[int, str] = field(default_factory=dict)
 
 
 @dataclass
@@ -75,17 +113,63 @@ def sample_price(state: SimulatorState) -> float:
     return sign * price
 
 
+def sample_clustered_price(state: SimulatorState, side: str) -> int:
+    """Sample a price near the drifting mid: bids below it, asks above."""
+    profile = state.profile
+    state.mid += random.randint(-profile.drift, profile.drift)
+    state.mid = max(
+        -MAX_PRICE + profile.spread, min(MAX_PRICE - profile.spread, state.mid)
+    )
+    offset = min(random.randint(0, profile.spread), random.randint(0, profile.spread))
+    return state.mid - offset if side == "Buy" else state.mid + offset
+
+
+def sample_order_price(state: SimulatorState, side: str) -> int:
+    """Sample a price for an order on the given side."""
+    if state.profile.clustered:
+        return sample_clustered_price(state, side)
+    return sample_price(state)
+
+
+def track_order(state: SimulatorState, order_id: int, side: str) -> None:
+    """Start tracking a live order."""
+    state.position[order_id] = len(state.live)
+    state.live.append(order_id)
+    state.sides[order_id] = side
+
+
+def forget_order(state: SimulatorState, order_id: int) -> None:
+    """Stop tracking a live order."""
+    i = state.position.pop(order_id)
+    del state.sides[order_id]
+    last = state.live.pop()
+    if last != order_id:
+        state.live[i] = last
+        state.position[last] = i
+
+
+def sample_live_order(state: SimulatorState) -> int:
+    """Sample the id of a live order."""
+    return state.live[random.randrange(len(state.live))]
+
+
 def sample_new_order(state: SimulatorState) -> CreateOrder:
     """Sample a new order."""
     side = sample_side(SimulatorState())
     quantity = sample_quantity(SimulatorState())
-    price = sample_price(SimulatorState())
+    price = sample_order_price(state, side)
+    if state.profile.live_targets:
+        track_order(state, state.largest_id, side)
     state.largest_id += 1
     return CreateOrder(side, quantity, price)
 
 
 def sample_update_order(state: SimulatorState) -> UpdateOrder:
     """Sample an update order."""
+    if state.profile.live_targets:
+        order_id = sample_live_order(state)
+        price = sample_order_price(state, state.sides[order_id])
+        return UpdateOrder(order_id, price)
     order_id = random.randint(0, state.largest_id)
     price = sample_price(state)
     return UpdateOrder(order_id, price)
@@ -93,21 +177,34 @@ def sample_update_order(state: SimulatorState) -> UpdateOrder:
 
 def sample_remove_order(state: SimulatorState) -> RemoveOrder:
     """Sample a remove order."""
+    if state.profile.live_targets:
+        order_id = sample_live_order(state)
+        forget_order(state, order_id)
+        return RemoveOrder(order_id)
     order_id = random.randint(0, state.largest_id)
     return RemoveOrder(order_id)
 
 
+EVENT_TYPES = ["CREATE", "UPDATE", "REMOVE", "BIDS", "ASKS"]
+
+
+def sample_event_type(state: SimulatorState) -> str:
+    """Sample an event type according to the profile's weights."""
+    r = random.randrange(sum(state.profile.weights))
+    for event_type, weight in zip(EVENT_TYPES, state.profile.weights):
+        if r < weight:
+            break
+        r -= weight
+    # With live targets there is nothing to update or remove in an empty book
+    if state.profile.live_targets and not state.live:
+        if event_type in ("UPDATE", "REMOVE"):
+            return "CREATE"
+    return event_type
+
+
 def sample_event(state: SimulatorState) -> Event:
     """Sample an event."""
-    event_type = random.choice(
-        [
-            "CREATE",
-            "UPDATE",
-            "REMOVE",
-            "BIDS",
-            "ASKS",
-        ]
-    )
+    event_type = sample_event_type(state)
     match event_type:
         case "CREATE":
             return sample_new_order(state)
@@ -143,9 +240,43 @@ def main():
         default="-",
         help="Output file for events",
     )
+    parser.add_argument(
+        "-p",
+        "--profile",
+        choices=PROFILES.keys(),
+        default="uniform",
+        help="Workload profile (default: uniform)",
+    )
+    parser.add_argument(
+        "--query-weight",
+        type=int,
+        default=None,
+        help="Override the profile's weight for each of BIDS and ASKS",
+    )
+    parser.add_argument(
+        "--seed",
+        type=int,
+        default=None,
+        help="Seed for the random generator, for reproducible runs",
+    )
     args = parser.parse_args()
 
-    state = SimulatorState()
+    if args.seed is not None:
+        random.seed(args.seed)
+
+    profile = PROFILES[args.profile]
+    if args.query_weight is not None:
+        create, update, remove, _, _ = profile.weights
+        weights = (create, update, remove, args.query_weight, args.query_weight)
+        profile = Profile(
+            weights,
+            profile.clustered,
+            profile.spread,
+            profile.drift,
+            profile.live_targets,
+        )
+
+    state = SimulatorState(profile=profile)
     for _ in range(args.num_updates):
         print(sample_event(state), file=args.output)
 